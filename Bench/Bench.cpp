@@ -0,0 +1,118 @@
+/*
+ Parse throughput of FileReader against the decompressing readers.
+
+ Writes a generated document plain, gzip and zstd compressed, then parses
+ each one a few times and prints MB/s of uncompressed JSON. It is not
+ part of the Visual Studio or Xcode projects and is built by hand with
+ the library sources, for example:
+
+   g++ -std=c++17 -O2 -DJACC_WITH_ZLIB -DJACC_WITH_ZSTD -IJACCLib \
+       JACCLib/[A-Z]*.cpp Bench/Bench.cpp -lz -lzstd -o bench
+
+ Pass a file name to use that JSON document instead of the generated one.
+ */
+#include <FileReader.h>
+#include <GzipReader.h>
+#include <ZstdReader.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+static const int RUNS = 5;
+
+static std::string generate() {
+    std::string json = "[";
+
+    for (int i = 0; i < 500000; ++i) {
+        json += (i ? ",\n" : "") + std::string("{\"id\": ") + std::to_string(i) +
+            ", \"name\": \"customer " + std::to_string(i) + "\", \"balance\": " +
+            std::to_string(i * 1.25) + ", \"active\": " + (i % 3 ? "true" : "false") +
+            ", \"location\": [" + std::to_string(i % 180 - 90.5) + ", " + std::to_string(i % 360 - 180.25) + "]}";
+    }
+
+    return json + "]";
+}
+
+template <typename ReaderT>
+static void run(const char* label, const char* file_name, size_t size) {
+    double best = 0;
+
+    for (int i = 0; i < RUNS; ++i) {
+        auto start = std::chrono::steady_clock::now();
+
+        ReaderT reader(file_name);
+        jacc::BasicParser<ReaderT> parser(reader);
+        jacc::JSONObject root = parser.parse();
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (parser.error_code != jacc::ERROR_NONE) {
+            std::cerr << label << ": " << parser.error_message << std::endl;
+
+            return;
+        }
+
+        double rate = size / elapsed.count() / (1024 * 1024);
+
+        if (rate > best) {
+            best = rate;
+        }
+    }
+
+    std::printf("%-12s %8.1f MB/s\n", label, best);
+}
+
+int main(int argc, char** argv) {
+    std::string json;
+
+    if (argc > 1) {
+        std::ifstream in(argv[1], std::ios::binary);
+
+        json.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    else {
+        json = generate();
+    }
+
+    const char* plain_name = "__bench.json";
+
+    {
+        std::ofstream out(plain_name, std::ios::binary);
+
+        out << json;
+    } //Closes file
+
+    std::printf("%.1f MB of JSON, best of %d runs\n", json.size() / (1024.0 * 1024.0), RUNS);
+
+    run<jacc::FileReader>("FileReader", plain_name, json.size());
+    std::remove(plain_name);
+
+#ifdef JACC_WITH_ZLIB
+    const char* gzip_name = "__bench.json.gz";
+    gzFile gz = gzopen(gzip_name, "wb");
+
+    gzwrite(gz, json.data(), static_cast<unsigned>(json.size()));
+    gzclose(gz);
+
+    run<jacc::GzipReader>("GzipReader", gzip_name, json.size());
+    std::remove(gzip_name);
+#endif
+
+#ifdef JACC_WITH_ZSTD
+    const char* zstd_name = "__bench.json.zst";
+    std::string compressed(ZSTD_compressBound(json.size()), '\0');
+    size_t compressed_size = ZSTD_compress(&compressed[0], compressed.size(), json.data(), json.size(), 3);
+
+    {
+        std::ofstream out(zstd_name, std::ios::binary);
+
+        out.write(compressed.data(), compressed_size);
+    } //Closes file
+
+    run<jacc::ZstdReader>("ZstdReader", zstd_name, json.size());
+    std::remove(zstd_name);
+#endif
+}
@@ -0,0 +1,114 @@
+/*
+ Scaling of ParallelRecordStream with the number of threads.
+
+ Writes generated newline delimited JSON, maps it with MemoryMappedReader
+ and parses it with 1, 2, 4, ... threads up to the hardware thread count,
+ in order and unordered. Prints MB/s and the speedup over one thread.
+ Like Bench.cpp it is built by hand with the library sources, for
+ example:
+
+   g++ -std=c++17 -O2 -pthread -IJACCLib JACCLib/[A-Z]*.cpp \
+       Bench/ParallelBench.cpp -o parallel_bench
+
+ Pass a file name to use that NDJSON file instead of the generated one.
+ */
+#include <MemoryMappedReader.h>
+#include <ParallelRecords.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static const int RUNS = 3;
+
+static void generate(const char* file_name) {
+    std::ofstream out(file_name, std::ios::binary);
+    std::string line;
+
+    for (int i = 0; i < 2000000; ++i) {
+        line = "{\"id\": " + std::to_string(i) + ", \"name\": \"customer " + std::to_string(i) +
+            "\", \"balance\": " + std::to_string(i * 1.25) + ", \"active\": " + (i % 3 ? "true" : "false") +
+            ", \"location\": [" + std::to_string(i % 180 - 90.5) + ", " + std::to_string(i % 360 - 180.25) + "]}\n";
+        out << line;
+    }
+}
+
+static double run(const char* file_name, size_t threads, bool ordered) {
+    double best = 0;
+
+    for (int i = 0; i < RUNS; ++i) {
+        auto start = std::chrono::steady_clock::now();
+
+        jacc::MemoryMappedReader reader(file_name);
+        jacc::ParallelOptions parallel;
+
+        parallel.threads = threads;
+
+        jacc::ParallelRecordStream stream(reader, jacc::ParseOptions(), parallel);
+        size_t size = stream.data.size();
+        std::atomic<size_t> records(0);
+        auto count = [&](jacc::JSONObject&, size_t) {
+            records.fetch_add(1, std::memory_order_relaxed);
+        };
+        bool ok = ordered ? stream.for_each(count) : stream.for_each_unordered(count);
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (!ok) {
+            std::cerr << "line " << stream.line << ": " << stream.error_message << std::endl;
+
+            return 0;
+        }
+
+        double rate = size / elapsed.count() / (1024 * 1024);
+
+        if (rate > best) {
+            best = rate;
+        }
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv) {
+    const char* file_name = "__bench.ndjson";
+
+    if (argc > 1) {
+        file_name = argv[1];
+    }
+    else {
+        generate(file_name);
+    }
+
+    size_t hardware = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    double base[2] = { 0, 0 };
+
+    std::printf("threads   ordered MB/s  speedup   unordered MB/s  speedup\n");
+
+    for (size_t threads = 1; ; threads *= 2) {
+        if (threads > hardware) {
+            threads = hardware;
+        }
+
+        double rates[2] = { run(file_name, threads, true), run(file_name, threads, false) };
+
+        if (threads == 1) {
+            base[0] = rates[0];
+            base[1] = rates[1];
+        }
+
+        std::printf("%7zu %14.1f %8.2f %16.1f %8.2f\n", threads,
+            rates[0], base[0] > 0 ? rates[0] / base[0] : 0,
+            rates[1], base[1] > 0 ? rates[1] / base[1] : 0);
+
+        if (threads == hardware) {
+            break;
+        }
+    }
+
+    if (argc <= 1) {
+        std::remove(file_name);
+    }
+}
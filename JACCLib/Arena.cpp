@@ -0,0 +1,62 @@
+#include "Arena.h"
+
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace jacc {
+	//Smallest page size of the supported platforms. Mappings start on a
+	//page boundary, so any alignment up to it is met.
+	static const size_t PAGE_ALIGNMENT = 4096;
+
+	void* PageResource::do_allocate(size_t bytes, size_t alignment) {
+		if (alignment > PAGE_ALIGNMENT) {
+			throw std::bad_alloc();
+		}
+
+#ifdef _WIN32
+		//Large pages need a privilege most processes do not have,
+		//so regular pages are used on Windows.
+		void* p = ::VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+		if (p == NULL) {
+			throw std::bad_alloc();
+		}
+#else
+		void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (p == MAP_FAILED) {
+			throw std::bad_alloc();
+		}
+#ifdef MADV_HUGEPAGE
+		//Transparent huge pages. Only a hint, failure is harmless.
+		::madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+#endif
+		return p;
+	}
+
+	void PageResource::do_deallocate(void* p, size_t bytes, size_t /*alignment*/) {
+#ifdef _WIN32
+		::VirtualFree(p, 0, MEM_RELEASE);
+#else
+		::munmap(p, bytes);
+#endif
+	}
+
+	bool PageResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+		return this == &other;
+	}
+
+	Arena::Arena(size_t initial_size, bool huge_pages) :
+		resource(initial_size, huge_pages ? static_cast<std::pmr::memory_resource*>(&pages) : std::pmr::new_delete_resource()) {
+	}
+
+	void Arena::release() {
+		resource.release();
+	}
+}
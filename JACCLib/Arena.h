@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory_resource>
+
+namespace jacc {
+	/*
+	 Memory resource that gets memory straight from the OS in whole pages
+	 and asks for huge pages where the platform allows it. Meant to be the
+	 upstream of an Arena, which only makes a few large requests. Memory
+	 is page aligned, and requests for a larger alignment throw
+	 std::bad_alloc.
+	 */
+	class PageResource : public std::pmr::memory_resource {
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+	};
+
+	/*
+	 Per document arena. Set ParseOptions::resource to &arena.resource and
+	 every object, array, key and string of the parsed tree comes from it.
+	 Allocation is a pointer bump and freeing is a no-op, and all of it is
+	 returned at once when the arena is destroyed or release() is called.
+	 The tree must not be used after that.
+	 */
+	struct Arena {
+		PageResource pages;
+		std::pmr::monotonic_buffer_resource resource;
+
+		Arena(size_t initial_size = 1024 * 1024, bool huge_pages = false);
+
+		void release();
+	};
+}
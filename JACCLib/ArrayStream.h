@@ -0,0 +1,177 @@
+#pragma once
+
+#include "Parser.h"
+
+namespace jacc {
+	/*
+	 Reads a document that is one big array an element at a time, from any
+	 reader, so memory is bounded by the largest element instead of the
+	 whole document:
+
+		for (JSONObject& element : array_stream(reader)) { ... }
+
+	 Each element replaces the previous one, which is freed before the
+	 next is parsed. Iteration stops at the end of the array or at the
+	 first error, so check error_code afterwards. Anything but whitespace
+	 after the array is an error. next() is the same without iterators.
+	 */
+	template <typename ReaderT>
+	class ArrayStream
+	{
+	public:
+		BasicParser<ReaderT> parser;
+		//The element the iterator is at
+		JSONObject current;
+		//Elements read so far
+		size_t count = 0;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+
+		class Iterator {
+		public:
+			ArrayStream* stream;
+
+			Iterator(ArrayStream* s) : stream(s) {
+			}
+
+			JSONObject& operator*() const {
+				return stream->current;
+			}
+
+			JSONObject* operator->() const {
+				return &stream->current;
+			}
+
+			Iterator& operator++() {
+				if (!stream->next(stream->current)) {
+					stream = nullptr;
+				}
+
+				return *this;
+			}
+
+			bool operator==(const Iterator& other) const {
+				return stream == other.stream;
+			}
+
+			bool operator!=(const Iterator& other) const {
+				return stream != other.stream;
+			}
+		};
+
+		ArrayStream(ReaderT& r) : parser(r) {
+			limit_depth();
+		}
+
+		ArrayStream(ReaderT& r, const ParseOptions& o) : parser(r, o) {
+			limit_depth();
+		}
+
+		ArrayStream(const ArrayStream&) = delete;
+		ArrayStream& operator=(const ArrayStream&) = delete;
+
+		//Reads the first element
+		Iterator begin() {
+			Iterator it(this);
+
+			return ++it;
+		}
+
+		Iterator end() {
+			return Iterator(nullptr);
+		}
+
+		//Parses the next element into element. Returns false after the
+		//last element or on error.
+		bool next(JSONObject& element) {
+			if (state == STATE_DONE) {
+				return false;
+			}
+
+			parser.eat_space();
+
+			char ch = parser.pop();
+
+			if (state == STATE_START) {
+				if (ch != '[') {
+					return fail(ERROR_SYNTAX, "Document does not start with '['.");
+				}
+
+				parser.eat_space();
+
+				if (parser.peek() == ']') {
+					parser.pop();
+
+					return finish();
+				}
+
+				state = STATE_ELEMENTS;
+			}
+			else if (ch == ']') {
+				return finish();
+			}
+			else if (ch != ',') {
+				return fail(ERROR_SYNTAX, ch == '\0' ? "Premature end of documnent while parsing an array." : "Invalid character in array.");
+			}
+
+			//Frees the previous element before the next one is parsed
+			element = JSONObject();
+			element = parser.parse_value();
+
+			if (parser.error_code != ERROR_NONE) {
+				return fail(parser.error_code, parser.error_message);
+			}
+
+			++count;
+
+			return true;
+		}
+
+	private:
+		enum State : char {
+			STATE_START,
+			STATE_ELEMENTS,
+			STATE_DONE
+		};
+
+		State state = STATE_START;
+
+		//The root array is one level of nesting
+		void limit_depth() {
+			if (parser.options.max_depth > 0) {
+				--parser.options.max_depth;
+			}
+		}
+
+		//Only whitespace may follow the array
+		bool finish() {
+			parser.eat_space();
+
+			if (parser.peek() != '\0') {
+				return fail(ERROR_SYNTAX, "Unexpected data after the document.");
+			}
+
+			state = STATE_DONE;
+
+			return false;
+		}
+
+		bool fail(ErrorCode code, const char* msg) {
+			error_code = code;
+			error_message = msg;
+			state = STATE_DONE;
+
+			return false;
+		}
+	};
+
+	template <typename ReaderT>
+	ArrayStream<ReaderT> array_stream(ReaderT& reader) {
+		return ArrayStream<ReaderT>(reader);
+	}
+
+	template <typename ReaderT>
+	ArrayStream<ReaderT> array_stream(ReaderT& reader, const ParseOptions& options) {
+		return ArrayStream<ReaderT>(reader, options);
+	}
+}
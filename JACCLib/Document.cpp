@@ -0,0 +1,29 @@
+#include "Document.h"
+
+namespace jacc {
+	static ParseOptions zero_copy_options() {
+		ParseOptions options;
+
+		options.zero_copy = true;
+
+		return options;
+	}
+
+	Document::Document(const char* file_name) : Document(file_name, zero_copy_options()) {
+	}
+
+	Document::Document(const char* file_name, const ParseOptions& options) : source(new MemoryMappedReader(file_name)) {
+		if (source->error_code != ERROR_NONE) {
+			error_code = source->error_code;
+			error_message = source->error_message;
+
+			return;
+		}
+
+		BasicParser<MemoryMappedReader> parser(*source, options);
+
+		root = parser.parse();
+		error_code = parser.error_code;
+		error_message = parser.error_message;
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "MemoryMappedReader.h"
+#include <memory>
+
+namespace jacc {
+	/*
+	 A document parsed from a memory mapped file. The mapping stays open as
+	 long as the Document exists, so strings parsed with zero_copy, which
+	 point into the mapping, stay valid. Moving a Document does not move
+	 the mapping.
+	 */
+	struct Document {
+		//Declared before root so that it is destroyed after it
+		std::unique_ptr<MemoryMappedReader> source;
+		JSONObject root;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+
+		//Parses with zero_copy turned on
+		Document(const char* file_name);
+		Document(const char* file_name, const ParseOptions& options);
+	};
+}
@@ -1,34 +1,92 @@
 #include "FileReader.h"
 
+#include <cerrno>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define JACC_OPEN ::_open
+#define JACC_READ ::_read
+#define JACC_CLOSE ::_close
+#define JACC_OPEN_FLAGS (_O_RDONLY | _O_BINARY)
+#else
+#include <unistd.h>
+#define JACC_OPEN ::open
+#define JACC_READ ::read
+#define JACC_CLOSE ::close
+#define JACC_OPEN_FLAGS O_RDONLY
+#endif
+
 namespace jacc {
-	FileReader::FileReader(const char* source) : file(source) {
+	FileReader::FileReader(const char* source, size_t buffer_size) : buffer(buffer_size < 2 ? 2 : buffer_size) {
+		fd = JACC_OPEN(source, JACC_OPEN_FLAGS);
+		owns_fd = fd >= 0;
 
+		if (fd < 0) {
+			save_error(ERROR_IO, "Could not open the file.");
+		}
 	}
 
-	FileReader::~FileReader() {
+	FileReader::FileReader(int descriptor, size_t buffer_size, bool own) : fd(descriptor), owns_fd(own), buffer(buffer_size < 2 ? 2 : buffer_size) {
 	}
 
-	char FileReader::peek() {
-		char result = file.peek();
-
-		if (result == EOF) {
-			return '\0';
+	FileReader::~FileReader() {
+		if (owns_fd && fd >= 0) {
+			JACC_CLOSE(fd);
 		}
+	}
 
-		return result;
+	bool FileReader::is_open() {
+		return fd >= 0;
 	}
 
-	char FileReader::pop() {
-		char result = file.get();
+	void FileReader::save_error(ErrorCode code, const char* msg) {
+		error_code = code;
+		error_message = msg;
+	}
 
-		if (result == EOF) {
-			return '\0';
+	/*
+	 Reads the next block of the file. The last byte of the previous
+	 block is kept at the front of the buffer so that a putback() right
+	 after a refill still works. A pipe may return less than a full block,
+	 that is not the end of input, only a read of 0 bytes is. A failed
+	 read is recorded in error_code and ends the input.
+	 */
+	bool FileReader::fill() {
+		if (fd < 0 || error_code != ERROR_NONE) {
+			return false;
 		}
 
-		return result;
-	}
+		if (length > 0) {
+			buffer[0] = buffer[length - 1];
+			location = 1;
+		}
+		else {
+			location = 0;
+		}
+
+		length = location;
+
+		while (true) {
+			auto count = JACC_READ(fd, buffer.data() + location, static_cast<unsigned int>(buffer.size() - location));
+
+			if (count < 0 && errno == EINTR) {
+				continue;
+			}
+			if (count < 0) {
+				save_error(ERROR_IO, "Could not read the file.");
 
-	void FileReader::putback() {
-		file.unget();
+				return false;
+			}
+			if (count == 0) {
+				return false;
+			}
+
+			length = location + static_cast<size_t>(count);
+
+			return true;
+		}
 	}
-}
\ No newline at end of file
+
+	template class BasicParser<FileReader>;
+}
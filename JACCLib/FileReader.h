@@ -1,21 +1,81 @@
 #pragma once
 #include "Parser.h"
-#include <fstream>
+#include <vector>
 
 namespace jacc {
+	/*
+	 Reads a file or any readable file descriptor, pipes and stdin
+	 included, in large blocks with read(2). Only the current block is
+	 kept, so putback() works within it (and for the one byte carried over
+	 a refill) but there is no seeking back further. If the file can not
+	 be opened or a read fails, input ends there and error_code and
+	 error_message say why, so a cut off document is not mistaken for a
+	 syntax error.
+	 */
 	struct FileReader :
 		public Reader
 	{
-		std::ifstream file;
+		static constexpr size_t BUFFER_SIZE = 64 * 1024;
 
-		FileReader(const char* source);
+		int fd = -1;
+		//Close fd in the destructor
+		bool owns_fd = false;
+		std::vector<char> buffer;
+		//Read position and number of valid bytes in buffer
+		size_t location = 0;
+		size_t length = 0;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
 
-		char peek();
-		char pop();
-		void putback();
+		FileReader(const char* source, size_t buffer_size = BUFFER_SIZE);
+		//Reads from an already open descriptor, like 0 for stdin.
+		//The descriptor is closed at the end only if own is true.
+		FileReader(int descriptor, size_t buffer_size = BUFFER_SIZE, bool own = false);
+
+		FileReader(const FileReader&) = delete;
+		FileReader& operator=(const FileReader&) = delete;
+
+		bool is_open();
+		bool fill();
+		void save_error(ErrorCode code, const char* msg);
+
+		char peek() final {
+			if (location < length || fill()) {
+				return buffer[location];
+			}
+
+			return '\0';
+		}
+
+		char pop() final {
+			if (location < length || fill()) {
+				return buffer[location++];
+			}
+
+			return '\0';
+		}
+
+		void putback() final {
+			if (location > 0) {
+				--location;
+			}
+		}
+
+		std::string_view window() final {
+			if (location < length || fill()) {
+				return std::string_view(buffer.data() + location, length - location);
+			}
+
+			return {};
+		}
+
+		void consume(size_t n) final {
+			location += n;
+		}
 
 		virtual ~FileReader();
 	};
-}
 
+	extern template class BasicParser<FileReader>;
+}
 
@@ -0,0 +1,107 @@
+#include "GzipReader.h"
+
+#ifdef JACC_WITH_ZLIB
+
+namespace jacc {
+	GzipReader::GzipReader(const char* file_name, size_t buffer_size) : source(file_name), buffer(buffer_size < 2 ? 2 : buffer_size) {
+		init();
+	}
+
+	GzipReader::GzipReader(int descriptor, size_t buffer_size, bool own) : source(descriptor, FileReader::BUFFER_SIZE, own), buffer(buffer_size < 2 ? 2 : buffer_size) {
+		init();
+	}
+
+	GzipReader::~GzipReader() {
+		::inflateEnd(&stream);
+	}
+
+	void GzipReader::init() {
+		stream = z_stream();
+
+		//15 window bits plus 32 detects gzip or zlib headers
+		if (::inflateInit2(&stream, 15 + 32) != Z_OK) {
+			save_error(ERROR_IO, "Could not initialize zlib.");
+		}
+		else if (!source.is_open()) {
+			save_error(ERROR_IO, "Could not open the file.");
+		}
+	}
+
+	void GzipReader::save_error(ErrorCode code, const char* msg) {
+		error_code = code;
+		error_message = msg;
+	}
+
+	/*
+	 Inflates the next block. As in FileReader the last byte of the
+	 previous block is kept at the front for putback().
+	 */
+	bool GzipReader::fill() {
+		if (error_code != ERROR_NONE || finished) {
+			return false;
+		}
+
+		if (length > 0) {
+			buffer[0] = buffer[length - 1];
+			location = 1;
+		}
+		else {
+			location = 0;
+		}
+
+		length = location;
+
+		//Until there is some output. A block that only fills part of the
+		//buffer is handed over rather than waiting on a slow pipe.
+		while (length == location) {
+			std::string_view in = source.window();
+
+			stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+			stream.avail_in = static_cast<uInt>(in.size());
+			stream.next_out = reinterpret_cast<Bytef*>(buffer.data() + length);
+			stream.avail_out = static_cast<uInt>(buffer.size() - length);
+
+			int result = ::inflate(&stream, Z_NO_FLUSH);
+
+			source.consume(in.size() - stream.avail_in);
+			length = buffer.size() - stream.avail_out;
+
+			if (result == Z_STREAM_END) {
+				//Another gzip member may follow
+				if (source.window().empty()) {
+					finished = true;
+
+					if (source.error_code != ERROR_NONE) {
+						save_error(source.error_code, source.error_message);
+					}
+
+					break;
+				}
+
+				::inflateReset(&stream);
+			}
+			else if (result == Z_BUF_ERROR && in.empty()) {
+				//Input ended in the middle of the stream
+				if (source.error_code != ERROR_NONE) {
+					save_error(source.error_code, source.error_message);
+				}
+				else {
+					save_error(ERROR_IO, "Compressed stream is truncated.");
+				}
+
+				break;
+			}
+			else if (result != Z_OK && result != Z_BUF_ERROR) {
+				save_error(ERROR_IO, "Compressed stream is corrupt.");
+
+				break;
+			}
+		}
+
+		return length > location;
+	}
+
+	template class BasicParser<GzipReader>;
+}
+
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+
+//Needs zlib. Define JACC_WITH_ZLIB and link with zlib to build it.
+#ifdef JACC_WITH_ZLIB
+
+#include "FileReader.h"
+#include <zlib.h>
+
+namespace jacc {
+	/*
+	 Decompresses a gzip or zlib stream while it is parsed, so compressed
+	 files and pipes can be read without inflating them first. Compressed
+	 bytes come from a FileReader and the output goes into a fixed size
+	 buffer that is refilled like FileReader's. Concatenated gzip members
+	 are read as one stream.
+	 */
+	struct GzipReader :
+		public Reader
+	{
+		static constexpr size_t BUFFER_SIZE = 256 * 1024;
+
+		FileReader source;
+		z_stream stream;
+		std::vector<char> buffer;
+		size_t location = 0;
+		size_t length = 0;
+		bool finished = false;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+
+		GzipReader(const char* file_name, size_t buffer_size = BUFFER_SIZE);
+		GzipReader(int descriptor, size_t buffer_size = BUFFER_SIZE, bool own = false);
+
+		GzipReader(const GzipReader&) = delete;
+		GzipReader& operator=(const GzipReader&) = delete;
+
+		void init();
+		bool fill();
+		void save_error(ErrorCode code, const char* msg);
+
+		char peek() final {
+			if (location < length || fill()) {
+				return buffer[location];
+			}
+
+			return '\0';
+		}
+
+		char pop() final {
+			if (location < length || fill()) {
+				return buffer[location++];
+			}
+
+			return '\0';
+		}
+
+		void putback() final {
+			if (location > 0) {
+				--location;
+			}
+		}
+
+		std::string_view window() final {
+			if (location < length || fill()) {
+				return std::string_view(buffer.data() + location, length - location);
+			}
+
+			return {};
+		}
+
+		void consume(size_t n) final {
+			location += n;
+		}
+
+		virtual ~GzipReader();
+	};
+
+	extern template class BasicParser<GzipReader>;
+}
+
+#endif
@@ -0,0 +1,219 @@
+#include "IndexedParser.h"
+
+namespace jacc {
+	IndexedParser::IndexedParser(StringReader& r) : reader(r), leaf_parser(r) {
+	}
+
+	IndexedParser::IndexedParser(StringReader& r, const ParseOptions& options) : reader(r), leaf_parser(r, options) {
+		//Projections are not supported, the whole tree is built
+		leaf_parser.options.projection = nullptr;
+	}
+
+	void IndexedParser::save_error(ErrorCode code, const char* msg) {
+		error_code = code;
+		error_message = msg;
+	}
+
+	JSONObject IndexedParser::parse() {
+		if (!index.build(reader.data)) {
+			save_error(index.error_code, index.error_message);
+
+			return JSONObject();
+		}
+
+		next = 0;
+
+		char ch = peek_structural();
+
+		if (ch != '{' && ch != '[') {
+			save_error(ERROR_SYNTAX, "Document does not start with '{' or '['.");
+
+			return JSONObject();
+		}
+
+		return parse_value();
+	}
+
+	/*
+	 Moves to the next structural position. Fails with a syntax
+	 error at the end of the index.
+	 */
+	bool IndexedParser::next_structural(size_t& pos) {
+		if (next >= index.positions.size()) {
+			save_error(ERROR_SYNTAX, "Premature end of document.");
+
+			return false;
+		}
+
+		pos = index.positions[next++];
+
+		return true;
+	}
+
+	//The character at the next structural position, or '\0' at the end.
+	char IndexedParser::peek_structural() {
+		if (next >= index.positions.size()) {
+			return '\0';
+		}
+
+		return reader.data[index.positions[next]];
+	}
+
+	JSONObject IndexedParser::parse_value() {
+		size_t pos;
+
+		if (!next_structural(pos)) {
+			return JSONObject();
+		}
+
+		char ch = reader.data[pos];
+
+		if (ch == '{' || ch == '[') {
+			if (depth >= leaf_parser.options.max_depth) {
+				save_error(ERROR_DEPTH, "Document is nested too deeply.");
+
+				return JSONObject();
+			}
+
+			++depth;
+
+			JSONObject result = ch == '{' ? parse_object() : parse_array();
+
+			--depth;
+
+			return result;
+		}
+		else if (ch == ']' || ch == '}' || ch == ',' || ch == ':') {
+			save_error(ERROR_SYNTAX, "Unexpected character.");
+
+			return JSONObject();
+		}
+		else {
+			return parse_leaf(pos);
+		}
+	}
+
+	/*
+	 Strings, numbers and literals are decoded by the regular parser
+	 positioned at the start of the value.
+	 */
+	JSONObject IndexedParser::parse_leaf(size_t pos) {
+		reader.location = pos;
+
+		JSONObject result = leaf_parser.parse_value();
+
+		if (leaf_parser.error_code != ERROR_NONE) {
+			save_error(leaf_parser.error_code, leaf_parser.error_message);
+
+			return JSONObject();
+		}
+
+		return result;
+	}
+
+	JSONObject IndexedParser::parse_object() {
+		JSONObject::Object map(leaf_parser.resource());
+		std::string name;
+		size_t pos;
+
+		name.reserve(25);
+
+		if (peek_structural() == '}') {
+			++next;
+
+			return JSONObject(map);
+		}
+
+		while (true) {
+			if (!next_structural(pos)) {
+				return JSONObject();
+			}
+
+			if (reader.data[pos] != '"') {
+				save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+				return JSONObject();
+			}
+
+			reader.location = pos;
+			leaf_parser.read_quoted_string(name);
+
+			if (leaf_parser.error_code != ERROR_NONE) {
+				save_error(leaf_parser.error_code, leaf_parser.error_message);
+
+				return JSONObject();
+			}
+
+			if (!next_structural(pos)) {
+				return JSONObject();
+			}
+
+			if (reader.data[pos] != ':') {
+				save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+				return JSONObject();
+			}
+
+			JSONObject value = parse_value();
+
+			if (error_code != ERROR_NONE) {
+				return JSONObject();
+			}
+
+			map.emplace(std::string_view(name), std::move(value));
+
+			if (!next_structural(pos)) {
+				return JSONObject();
+			}
+
+			char ch = reader.data[pos];
+
+			if (ch == '}') {
+				break;
+			}
+			else if (ch != ',') {
+				save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+				return JSONObject();
+			}
+		}
+
+		return JSONObject(map);
+	}
+
+	JSONObject IndexedParser::parse_array() {
+		ArrayBuilder list(leaf_parser.resource(), leaf_parser.options.pack_arrays);
+		size_t pos;
+
+		if (peek_structural() == ']') {
+			++next;
+
+			return list.finish();
+		}
+
+		while (true) {
+			list.push(parse_value());
+
+			if (error_code != ERROR_NONE) {
+				return JSONObject();
+			}
+
+			if (!next_structural(pos)) {
+				return JSONObject();
+			}
+
+			char ch = reader.data[pos];
+
+			if (ch == ']') {
+				break;
+			}
+			else if (ch != ',') {
+				save_error(ERROR_SYNTAX, "Invalid character in array.");
+
+				return JSONObject();
+			}
+		}
+
+		return list.finish();
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "StringReader.h"
+#include "StructuralIndex.h"
+
+namespace jacc {
+	/*
+	 Two stage parser for documents that are fully in memory (StringReader
+	 and MemoryMappedReader). parse() first builds a StructuralIndex and then
+	 builds the JSONObject tree by walking the index, so finding the next
+	 structural character is an array lookup instead of a scan. Strings,
+	 numbers and literals are still decoded by BasicParser.
+	 */
+	class IndexedParser
+	{
+	public:
+		StringReader& reader;
+		StructuralIndex index;
+		BasicParser<StringReader> leaf_parser;
+		//Next entry of index.positions to be read
+		size_t next = 0;
+		//Objects and arrays open, limited by ParseOptions::max_depth
+		size_t depth = 0;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+
+		IndexedParser(StringReader& r);
+		IndexedParser(StringReader& r, const ParseOptions& options);
+		void save_error(ErrorCode code, const char* msg);
+		bool next_structural(size_t& pos);
+		char peek_structural();
+		JSONObject parse();
+		JSONObject parse_value();
+		JSONObject parse_object();
+		JSONObject parse_array();
+		JSONObject parse_leaf(size_t pos);
+	};
+}
@@ -1,6 +1,7 @@
 #include "MemoryMappedReader.h"
 
 #ifndef _WIN32
+#include <cerrno>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -8,73 +9,180 @@
 #endif
 
 namespace jacc {
-	MemoryMappedReader::MemoryMappedReader(const char* file_name) : StringReader() {
+	MemoryMappedReader::MemoryMappedReader(const char* file_name) : MemoryMappedReader(file_name, MappingOptions()) {
+	}
+
+	MemoryMappedReader::MemoryMappedReader(const char* file_name, const MappingOptions& options) : StringReader() {
 #ifdef _WIN32
-        file_handle = ::CreateFileA(file_name, GENERIC_READ, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        file_handle = ::CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+            options.sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, NULL);
 
         if (file_handle == INVALID_HANDLE_VALUE)
         {
+            save_error(ERROR_IO, "Could not open the file.");
+
+            return;
+        }
+
+        LARGE_INTEGER size;
+
+        if (!::GetFileSizeEx(file_handle, &size)) {
+            save_error(ERROR_IO, "Could not get the size of the file.");
+
+            return;
+        }
+
+        file_size = static_cast<size_t>(size.QuadPart);
+
+        if (file_size < options.read_threshold) {
+            contents.resize(file_size);
+
+            size_t done = 0;
+
+            while (done < file_size) {
+                DWORD count = 0;
+
+                if (!::ReadFile(file_handle, contents.data() + done, static_cast<DWORD>(file_size - done), &count, NULL) || count == 0) {
+                    contents.clear();
+                    save_error(ERROR_IO, "Could not read the file.");
+
+                    return;
+                }
+
+                done += count;
+            }
+
+            strategy = INPUT_READ;
+            data = std::string_view(contents.data(), file_size);
+
             return;
         }
 
         map_handle = ::CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
 
-        if (map_handle == INVALID_HANDLE_VALUE)
+        if (map_handle == NULL)
         {
+            save_error(ERROR_IO, "Could not map the file.");
+
             return;
         }
 
         const char* buff = (const char*) ::MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
 
         if (buff == NULL) {
+            save_error(ERROR_IO, "Could not map the file.");
+
             return;
         }
 
-        DWORD file_size = ::GetFileSize(file_handle, NULL);
+        if (options.populate) {
+            WIN32_MEMORY_RANGE_ENTRY range;
+
+            range.VirtualAddress = (PVOID) buff;
+            range.NumberOfBytes = file_size;
+
+            ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+        }
 
+        strategy = INPUT_MMAP;
         data = std::string_view(buff, file_size);
 #endif
 #ifndef _WIN32
         file_handle = ::open(file_name, O_RDONLY);
         
         if (file_handle < 0) {
-            perror("open() failed");
+            save_error(ERROR_IO, "Could not open the file.");
             
             return;
         }
         
         struct stat sbuf;
         
-        if (stat(file_name, &sbuf) == -1) {
-            perror("stat() failed");
+        if (::fstat(file_handle, &sbuf) == -1) {
+            save_error(ERROR_IO, "Could not get the size of the file.");
             
             return;
         }
 
         file_size = sbuf.st_size;
-        
-        void *start = ::mmap(nullptr, file_size, PROT_READ, MAP_FILE | MAP_SHARED, file_handle, 0);
+
+        if (file_size < options.read_threshold) {
+            contents.resize(file_size);
+
+            size_t done = 0;
+
+            while (done < file_size) {
+                ssize_t count = ::pread(file_handle, contents.data() + done, file_size - done, done);
+
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (count <= 0) {
+                    contents.clear();
+                    save_error(ERROR_IO, "Could not read the file.");
+
+                    return;
+                }
+
+                done += count;
+            }
+
+            strategy = INPUT_READ;
+            data = std::string_view(contents.data(), file_size);
+
+            return;
+        }
+
+        int flags = MAP_SHARED;
+
+#ifdef MAP_POPULATE
+        if (options.populate) {
+            flags |= MAP_POPULATE;
+        }
+#endif
+
+        void *start = ::mmap(nullptr, file_size, PROT_READ, flags, file_handle, 0);
         
         if (start == MAP_FAILED) {
-            perror("mmap() failed");
+            save_error(ERROR_IO, "Could not map the file.");
             
             return;
         }
-        
+
+        //The hints are advisory, failures are ignored
+        if (options.sequential) {
+            ::madvise(start, file_size, MADV_SEQUENTIAL);
+        }
+#ifdef MADV_HUGEPAGE
+        if (options.huge_pages) {
+            ::madvise(start, file_size, MADV_HUGEPAGE);
+        }
+#endif
+#ifndef MAP_POPULATE
+        if (options.populate) {
+            ::madvise(start, file_size, MADV_WILLNEED);
+        }
+#endif
+
+        strategy = INPUT_MMAP;
         data = std::string_view(reinterpret_cast<const char*>(start), file_size);
 #endif
 	}
 
+	void MemoryMappedReader::save_error(ErrorCode code, const char* msg) {
+		error_code = code;
+		error_message = msg;
+	}
+
     MemoryMappedReader::~MemoryMappedReader() {
 #ifdef _WIN32
-        if (map_handle != INVALID_HANDLE_VALUE) {
-            if (data.data() != nullptr) {
-                ::UnmapViewOfFile(data.data());
-            }
-
+        if (strategy == INPUT_MMAP) {
+            ::UnmapViewOfFile(data.data());
+        }
+        if (map_handle != NULL) {
             ::CloseHandle(map_handle);
 
-            map_handle = INVALID_HANDLE_VALUE;
+            map_handle = NULL;
         }
         if (file_handle != INVALID_HANDLE_VALUE) {
             ::CloseHandle(file_handle);
@@ -83,13 +191,15 @@ namespace jacc {
         }
 #endif
 #ifndef _WIN32
-        if (::munmap((void*) data.data(), file_size) < 0) {
-            perror("munmap() failed.");
+        if (strategy == INPUT_MMAP) {
+            ::munmap((void*) data.data(), file_size);
         }
         
-        if (::close(file_handle) < 0) {
-            perror("close() failed.");
+        if (file_handle >= 0) {
+            ::close(file_handle);
         }
 #endif
     }
+
+    template class BasicParser<MemoryMappedReader>;
 }
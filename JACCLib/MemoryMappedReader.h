@@ -1,26 +1,65 @@
 #pragma once
 
 #include "StringReader.h"
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
 #endif // _WIN32
 
 namespace jacc {
+	//How MemoryMappedReader got the file into memory
+	enum InputStrategy : char {
+		INPUT_NONE,
+		INPUT_MMAP,
+		INPUT_READ
+	};
+
+	struct MappingOptions {
+		//Files smaller than this are read into a buffer with one read
+		//instead of being mapped. Setting up and tearing down a mapping
+		//costs more than copying a small file.
+		size_t read_threshold = 256 * 1024;
+		//Tell the OS the file will be read front to back, so it reads ahead
+		bool sequential = true;
+		//Ask for huge pages where the platform supports it for file mappings
+		bool huge_pages = true;
+		//Fault in the whole mapping up front (MAP_POPULATE on Linux)
+		//instead of taking a page fault per page while parsing
+		bool populate = false;
+	};
+
+	/*
+	 Gives the parser a whole file as one block of memory, either mapped or
+	 read, see MappingOptions. On failure data is empty and error_code and
+	 error_message say why.
+	 */
 	struct MemoryMappedReader :
 		public StringReader
 	{
 #ifdef _WIN32
 		HANDLE file_handle = INVALID_HANDLE_VALUE;
-		HANDLE map_handle = INVALID_HANDLE_VALUE;
+		HANDLE map_handle = NULL;
 #endif
 #ifndef _WIN32
         int file_handle = -1;
-        size_t file_size = 0;
 #endif
+        size_t file_size = 0;
+		InputStrategy strategy = INPUT_NONE;
+		//Holds the file when it is read instead of mapped
+		std::vector<char> contents;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+
 		MemoryMappedReader(const char* file_name);
+		MemoryMappedReader(const char* file_name, const MappingOptions& options);
+
+		MemoryMappedReader(const MemoryMappedReader&) = delete;
+		MemoryMappedReader& operator=(const MemoryMappedReader&) = delete;
+
+		void save_error(ErrorCode code, const char* msg);
 		virtual ~MemoryMappedReader();
 	};
-}
-
 
+	extern template class BasicParser<MemoryMappedReader>;
+}
@@ -0,0 +1,265 @@
+#include "Number.h"
+
+#include <charconv>
+#include <limits>
+
+//Floating point std::from_chars is missing from some standard libraries,
+//notably Apple's libc++. Those get a strtod_l based conversion that is
+//just as locale independent. Define JACC_STRTOD_FALLBACK to use it
+//everywhere.
+#if !defined(__cpp_lib_to_chars) && !defined(JACC_STRTOD_FALLBACK)
+#define JACC_STRTOD_FALLBACK
+#endif
+
+#ifdef JACC_STRTOD_FALLBACK
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#endif
+
+namespace jacc {
+	static inline bool is_digit(char ch) {
+		return ch >= '0' && ch <= '9';
+	}
+
+	/*
+	 Matches the JSON number grammar against the whole of [first, last)
+	 and reports where the integer digits are and whether there is a
+	 fraction or exponent.
+	 */
+	static bool match_number(const char* first, const char* last, bool& negative, const char*& digits, size_t& digit_count, bool& integer) {
+		const char* p = first;
+
+		negative = false;
+		integer = true;
+
+		if (p != last && *p == '-') {
+			negative = true;
+			++p;
+		}
+
+		digits = p;
+
+		if (p == last || !is_digit(*p)) {
+			return false;
+		}
+
+		if (*p == '0') {
+			++p;
+		}
+		else {
+			while (p != last && is_digit(*p)) {
+				++p;
+			}
+		}
+
+		digit_count = p - digits;
+
+		if (p != last && *p == '.') {
+			++p;
+			integer = false;
+
+			if (p == last || !is_digit(*p)) {
+				return false;
+			}
+
+			while (p != last && is_digit(*p)) {
+				++p;
+			}
+		}
+
+		if (p != last && (*p == 'e' || *p == 'E')) {
+			++p;
+			integer = false;
+
+			if (p != last && (*p == '+' || *p == '-')) {
+				++p;
+			}
+
+			if (p == last || !is_digit(*p)) {
+				return false;
+			}
+
+			while (p != last && is_digit(*p)) {
+				++p;
+			}
+		}
+
+		//Anything left is trailing garbage, like "12abc" or a leading
+		//zero as in "012"
+		return p == last;
+	}
+
+	/*
+	 For a valid number that from_chars found out of range, tells whether
+	 it is too small rather than too large, from the decimal exponent of
+	 its first significant digit.
+	 */
+	static bool underflows(const char* digits, const char* last) {
+		const char* p = digits;
+		long long magnitude = 0;
+
+		while (p != last && is_digit(*p)) {
+			++p;
+		}
+
+		if (*digits != '0') {
+			magnitude = (p - digits) - 1;
+		}
+		else if (p != last && *p == '.') {
+			++p;
+			magnitude = -1;
+
+			while (p != last && *p == '0') {
+				++p;
+				--magnitude;
+			}
+		}
+
+		while (p != last && *p != 'e' && *p != 'E') {
+			++p;
+		}
+
+		if (p == last) {
+			return magnitude < 0;
+		}
+
+		++p;
+
+		bool negative_exponent = *p == '-';
+		long long exponent = 0;
+
+		if (*p == '+' || *p == '-') {
+			++p;
+		}
+
+		//Saturates, anything this large is out of range either way
+		for (; p != last && exponent < 1000000; ++p) {
+			exponent = exponent * 10 + (*p - '0');
+		}
+
+		return magnitude + (negative_exponent ? -exponent : exponent) < 0;
+	}
+
+#ifdef JACC_STRTOD_FALLBACK
+	//Converts a valid number like std::from_chars does, including
+	//reporting both overflow and underflow as out of range.
+	static std::from_chars_result convert_double(const char* first, const char* last, double& value) {
+#ifdef _WIN32
+		static _locale_t c_locale = _create_locale(LC_ALL, "C");
+#else
+		static locale_t c_locale = newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(0));
+#endif
+		//strtod needs a terminated string
+		std::string text(first, last);
+		char* end = nullptr;
+
+		errno = 0;
+
+#ifdef _WIN32
+		double d = _strtod_l(text.c_str(), &end, c_locale);
+#else
+		double d = strtod_l(text.c_str(), &end, c_locale);
+#endif
+		std::from_chars_result result{ first + (end - text.c_str()), std::errc() };
+
+		if (errno == ERANGE && (std::isinf(d) || d == 0.0)) {
+			result.ec = std::errc::result_out_of_range;
+		}
+		else {
+			value = d;
+		}
+
+		return result;
+	}
+#else
+	static std::from_chars_result convert_double(const char* first, const char* last, double& value) {
+		return std::from_chars(first, last, value);
+	}
+#endif
+
+	bool valid_number(const char* first, const char* last) {
+		bool negative, integer;
+		const char* digits;
+		size_t digit_count;
+
+		return match_number(first, last, negative, digits, digit_count, integer);
+	}
+
+	Number scan_number(const char* first, const char* last) {
+		Number result;
+		bool negative, integer;
+		const char* digits;
+		size_t digit_count;
+
+		if (!match_number(first, last, negative, digits, digit_count, integer)) {
+			return result;
+		}
+
+		//Integer fast path. 19 digits always fit in a uint64_t.
+		if (integer && digit_count <= 20) {
+			uint64_t u = 0;
+			bool overflow = false;
+
+			for (const char* d = digits; d != digits + digit_count; ++d) {
+				uint64_t digit = *d - '0';
+
+				if (digit_count == 20 && u > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+					overflow = true;
+
+					break;
+				}
+
+				u = u * 10 + digit;
+			}
+
+			if (!overflow) {
+				if (!negative) {
+					if (u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+						result.type = NUMBER_INT64;
+						result.i = static_cast<int64_t>(u);
+					}
+					else {
+						result.type = NUMBER_UINT64;
+						result.u = u;
+					}
+
+					return result;
+				}
+				else if (u != 0 && u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1) {
+					result.type = NUMBER_INT64;
+					result.i = static_cast<int64_t>(0 - u);
+
+					return result;
+				}
+			}
+
+			//Too big for 64 bits, or -0 which only a double can hold. Fall
+			//through to double.
+		}
+
+		auto r = convert_double(first, last, result.d);
+
+		if (r.ec == std::errc::result_out_of_range && underflows(digits, last)) {
+			//Too small for even a denormal. Rounds to zero like strtod.
+			result.type = NUMBER_DOUBLE;
+			result.d = negative ? -0.0 : 0.0;
+		}
+		else if (r.ec == std::errc::result_out_of_range) {
+			result.type = NUMBER_OUT_OF_RANGE;
+		}
+		else if (r.ec != std::errc() || r.ptr != last) {
+			result.type = NUMBER_INVALID;
+		}
+		else {
+			result.type = NUMBER_DOUBLE;
+		}
+
+		return result;
+	}
+}
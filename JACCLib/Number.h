@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace jacc {
+	enum NumberType : char {
+		NUMBER_INVALID,
+		NUMBER_OUT_OF_RANGE,
+		NUMBER_INT64,
+		NUMBER_UINT64,
+		NUMBER_DOUBLE
+	};
+
+	struct Number {
+		NumberType type = NUMBER_INVALID;
+
+		union {
+			int64_t i;
+			uint64_t u;
+			double d;
+		};
+	};
+
+	/*
+	 Parses the JSON number that exactly spans [first, last). Strict JSON
+	 grammar: no leading '+', no leading zeros, digits on both sides of
+	 the '.', and nothing after the number. Integers without a fraction or
+	 exponent that fit in 64 bits are returned as NUMBER_INT64, or as
+	 NUMBER_UINT64 above INT64_MAX, so large IDs are exact. Anything else
+	 is converted to a double with std::from_chars, which is locale
+	 independent and correctly rounded, or with strtod_l in the "C" locale
+	 where the standard library lacks it.
+	 */
+	Number scan_number(const char* first, const char* last);
+
+	//Checks the grammar only, without converting.
+	bool valid_number(const char* first, const char* last);
+
+	/*
+	 A number kept as its source text, see ParseOptions::lazy_numbers.
+	 value caches the conversion and is NUMBER_INVALID until the first
+	 time the number is read.
+	 */
+	struct RawNumber {
+		std::string_view text;
+		Number value;
+
+		const Number& convert() {
+			if (value.type == NUMBER_INVALID) {
+				value = scan_number(text.data(), text.data() + text.size());
+			}
+
+			return value;
+		}
+	};
+}
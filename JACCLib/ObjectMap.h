@@ -0,0 +1,213 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <tuple>
+#include <functional>
+#include <memory_resource>
+#include <cstdint>
+
+namespace jacc {
+	/*
+	 Object member storage. Members are kept in one contiguous vector in
+	 the order they were added, so iterating and looking up keys in the
+	 small objects that make up most documents touches a few adjacent
+	 cache lines instead of a tree of separately allocated nodes. Lookups
+	 scan linearly until the object has HASH_THRESHOLD members. From then
+	 on an open addressing hash index of member positions is kept next to
+	 the vector.
+
+	 The interface follows std::map closely enough for existing callers:
+	 operator[] adds a missing member and emplace() keeps the first value
+	 added for a key. Unlike std::map, adding members may move existing
+	 ones, so references into the map are only stable until the next
+	 insert.
+	 */
+	template <typename V>
+	class ObjectMap {
+	public:
+		using key_type = std::pmr::string;
+		using mapped_type = V;
+		using value_type = std::pair<std::pmr::string, V>;
+		using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+		using iterator = typename std::pmr::vector<value_type>::iterator;
+		using const_iterator = typename std::pmr::vector<value_type>::const_iterator;
+
+		static constexpr size_t HASH_THRESHOLD = 16;
+
+		ObjectMap() = default;
+
+		explicit ObjectMap(std::pmr::memory_resource* r) :
+			entries(r ? r : std::pmr::get_default_resource()),
+			slots(r ? r : std::pmr::get_default_resource()) {
+		}
+
+		size_t size() const {
+			return entries.size();
+		}
+
+		bool empty() const {
+			return entries.empty();
+		}
+
+		void reserve(size_t n) {
+			entries.reserve(n);
+		}
+
+		void clear() {
+			entries.clear();
+			slots.clear();
+		}
+
+		allocator_type get_allocator() const {
+			return entries.get_allocator();
+		}
+
+		iterator begin() {
+			return entries.begin();
+		}
+
+		iterator end() {
+			return entries.end();
+		}
+
+		const_iterator begin() const {
+			return entries.begin();
+		}
+
+		const_iterator end() const {
+			return entries.end();
+		}
+
+		iterator find(std::string_view key) {
+			return entries.begin() + position(key);
+		}
+
+		const_iterator find(std::string_view key) const {
+			return entries.begin() + position(key);
+		}
+
+		size_t count(std::string_view key) const {
+			return position(key) == entries.size() ? 0 : 1;
+		}
+
+		//Adds value under key unless there already is a member by that
+		//name, in which case value is discarded. Returns the member and
+		//whether it was added.
+		template <typename... Args>
+		std::pair<iterator, bool> emplace(std::string_view key, Args&&... args) {
+			size_t hash = 0;
+
+			if (!slots.empty()) {
+				hash = std::hash<std::string_view>()(key);
+
+				size_t i = lookup(key, hash);
+
+				if (i != entries.size()) {
+					return { entries.begin() + i, false };
+				}
+			}
+			else {
+				size_t i = scan(key);
+
+				if (i != entries.size()) {
+					return { entries.begin() + i, false };
+				}
+			}
+
+			entries.emplace_back(std::piecewise_construct,
+				std::forward_as_tuple(key),
+				std::forward_as_tuple(std::forward<Args>(args)...));
+
+			if (!slots.empty()) {
+				if (entries.size() * 2 > slots.size()) {
+					rebuild();
+				}
+				else {
+					insert_slot(hash, entries.size() - 1);
+				}
+			}
+			else if (entries.size() >= HASH_THRESHOLD) {
+				rebuild();
+			}
+
+			return { entries.end() - 1, true };
+		}
+
+		//Like std::map, adds a default constructed member if there is
+		//none by that name.
+		V& operator[](std::string_view key) {
+			return emplace(key).first->second;
+		}
+
+	private:
+		std::pmr::vector<value_type> entries;
+		//Hash index, entry position + 1 per slot and 0 for an empty slot.
+		//Only used once there are HASH_THRESHOLD members.
+		std::pmr::vector<uint32_t> slots;
+
+		size_t scan(std::string_view key) const {
+			size_t n = entries.size();
+
+			for (size_t i = 0; i < n; ++i) {
+				const std::pmr::string& k = entries[i].first;
+
+				if (k.size() == key.size() && std::char_traits<char>::compare(k.data(), key.data(), key.size()) == 0) {
+					return i;
+				}
+			}
+
+			return n;
+		}
+
+		size_t lookup(std::string_view key, size_t hash) const {
+			size_t mask = slots.size() - 1;
+
+			for (size_t s = hash & mask; slots[s] != 0; s = (s + 1) & mask) {
+				size_t i = slots[s] - 1;
+
+				if (std::string_view(entries[i].first) == key) {
+					return i;
+				}
+			}
+
+			return entries.size();
+		}
+
+		size_t position(std::string_view key) const {
+			if (slots.empty()) {
+				return scan(key);
+			}
+
+			return lookup(key, std::hash<std::string_view>()(key));
+		}
+
+		void insert_slot(size_t hash, size_t i) {
+			size_t mask = slots.size() - 1;
+			size_t s = hash & mask;
+
+			while (slots[s] != 0) {
+				s = (s + 1) & mask;
+			}
+
+			slots[s] = static_cast<uint32_t>(i + 1);
+		}
+
+		//Sizes the index to at most half full and refills it.
+		void rebuild() {
+			size_t capacity = HASH_THRESHOLD * 2;
+
+			while (capacity < entries.size() * 4) {
+				capacity *= 2;
+			}
+
+			slots.assign(capacity, 0);
+
+			for (size_t i = 0; i < entries.size(); ++i) {
+				insert_slot(std::hash<std::string_view>()(entries[i].first), i);
+			}
+		}
+	};
+}
@@ -0,0 +1,417 @@
+#include "OnDemand.h"
+
+#include <limits>
+
+namespace jacc {
+	static const size_t NPOS = static_cast<size_t>(-1);
+
+	OnDemand::OnDemand(StringReader& r) : reader(r), parser(r) {
+	}
+
+	//Keeps the first error, later ones are often caused by it.
+	void OnDemand::save_error(ErrorCode code, const char* msg) {
+		if (error_code == ERROR_NONE) {
+			error_code = code;
+			error_message = msg;
+		}
+	}
+
+	//Picks up a parse error. The parser is reset so later lookups can
+	//still be tried, but the document keeps the error.
+	bool OnDemand::failed() {
+		if (parser.error_code == ERROR_NONE) {
+			return false;
+		}
+
+		save_error(parser.error_code, parser.error_message);
+		parser.error_code = ERROR_NONE;
+		parser.error_message = nullptr;
+
+		return true;
+	}
+
+	//Moves to a value and checks that it is of the expected kind,
+	//one of the START_ codes.
+	bool OnDemand::seek(size_t position, uint8_t expected) {
+		if (position == NPOS) {
+			save_error(ERROR_INVALID_TYPE, "Value does not exist.");
+
+			return false;
+		}
+
+		reader.location = position;
+
+		if (VALUE_START[static_cast<unsigned char>(reader.peek())] != expected) {
+			save_error(ERROR_INVALID_TYPE, "Value is not of the requested type.");
+
+			return false;
+		}
+
+		return true;
+	}
+
+	//Checks that the input does not end where a value should start
+	bool OnDemand::value_follows() {
+		if (reader.location >= reader.data.size()) {
+			save_error(ERROR_SYNTAX, "Premature end of document.");
+
+			return false;
+		}
+
+		return true;
+	}
+
+	OnDemandValue OnDemand::root() {
+		reader.location = 0;
+		parser.eat_space();
+
+		char ch = reader.peek();
+
+		if (ch != '{' && ch != '[') {
+			save_error(ERROR_SYNTAX, "Document does not start with '{' or '['.");
+
+			return OnDemandValue(this, NPOS);
+		}
+
+		return OnDemandValue(this, reader.location);
+	}
+
+	OnDemandValue OnDemand::operator[](std::string_view name) {
+		return root()[name];
+	}
+
+	OnDemandValue OnDemand::operator[](const char* name) {
+		return root()[std::string_view(name)];
+	}
+
+	OnDemandValue OnDemand::operator[](size_t index) {
+		return root()[index];
+	}
+
+	OnDemandValue OnDemand::operator[](int index) {
+		return root()[static_cast<size_t>(index)];
+	}
+
+	OnDemandValue::OnDemandValue() {
+	}
+
+	OnDemandValue::OnDemandValue(OnDemand* d, size_t s) : document(d), start(s) {
+	}
+
+	OnDemandValue OnDemandValue::operator[](std::string_view name) {
+		if (document == nullptr) {
+			return OnDemandValue();
+		}
+
+		OnDemandValue missing(document, NPOS);
+
+		if (!document->seek(start, START_OBJECT)) {
+			return missing;
+		}
+
+		BasicParser<StringReader>& p = document->parser;
+		std::string_view key;
+
+		p.pop();
+		p.eat_space();
+
+		if (p.peek() == '}') {
+			return missing;
+		}
+
+		while (true) {
+			p.eat_space();
+
+			if (p.peek() != '"') {
+				document->save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+				return missing;
+			}
+
+			p.read_string_view(key);
+
+			if (document->failed()) {
+				return missing;
+			}
+
+			p.eat_space();
+
+			if (p.pop() != ':') {
+				document->save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+				return missing;
+			}
+
+			p.eat_space();
+
+			if (!document->value_follows()) {
+				return missing;
+			}
+
+			if (key == name) {
+				return OnDemandValue(document, document->reader.location);
+			}
+
+			p.skip_value();
+
+			if (document->failed()) {
+				return missing;
+			}
+
+			p.eat_space();
+
+			char ch = p.pop();
+
+			if (ch == '}') {
+				//No such member
+				return missing;
+			}
+			else if (ch != ',') {
+				document->save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+				return missing;
+			}
+		}
+	}
+
+	OnDemandValue OnDemandValue::operator[](const char* name) {
+		return (*this)[std::string_view(name)];
+	}
+
+	OnDemandValue OnDemandValue::operator[](size_t index) {
+		for (Iterator it = begin(); it != end(); ++it) {
+			if (index-- == 0) {
+				return *it;
+			}
+		}
+
+		return OnDemandValue(document, NPOS);
+	}
+
+	OnDemandValue OnDemandValue::operator[](int index) {
+		return (*this)[static_cast<size_t>(index)];
+	}
+
+	OnDemandValue::Iterator OnDemandValue::begin() {
+		if (document == nullptr || !document->seek(start, START_ARRAY)) {
+			return end();
+		}
+
+		BasicParser<StringReader>& p = document->parser;
+
+		p.pop();
+		p.eat_space();
+
+		if (p.peek() == ']' || !document->value_follows()) {
+			return end();
+		}
+
+		return Iterator{document, document->reader.location};
+	}
+
+	OnDemandValue::Iterator OnDemandValue::end() {
+		return Iterator{document, NPOS};
+	}
+
+	OnDemandValue OnDemandValue::Iterator::operator*() {
+		return OnDemandValue(document, position);
+	}
+
+	OnDemandValue::Iterator& OnDemandValue::Iterator::operator++() {
+		BasicParser<StringReader>& p = document->parser;
+
+		document->reader.location = position;
+		position = NPOS;
+		p.skip_value();
+
+		if (document->failed()) {
+			return *this;
+		}
+
+		p.eat_space();
+
+		char ch = p.pop();
+
+		if (ch == ',') {
+			p.eat_space();
+
+			if (document->value_follows()) {
+				position = document->reader.location;
+			}
+		}
+		else if (ch != ']') {
+			document->save_error(ERROR_SYNTAX, "Invalid character in array.");
+		}
+
+		return *this;
+	}
+
+	bool OnDemandValue::Iterator::operator!=(const Iterator& other) const {
+		return position != other.position;
+	}
+
+	bool OnDemandValue::isUndefined() {
+		return document == nullptr || start == NPOS;
+	}
+
+	static uint8_t value_start(OnDemandValue& v) {
+		if (v.isUndefined()) {
+			return START_INVALID;
+		}
+
+		if (v.start >= v.document->reader.data.size()) {
+			v.document->save_error(ERROR_SYNTAX, "Premature end of document.");
+
+			return START_INVALID;
+		}
+
+		return VALUE_START[static_cast<unsigned char>(v.document->reader.data[v.start])];
+	}
+
+	bool OnDemandValue::isNull() {
+		return value_start(*this) == START_NULL;
+	}
+
+	bool OnDemandValue::isString() {
+		return value_start(*this) == START_STRING;
+	}
+
+	bool OnDemandValue::isNumber() {
+		return value_start(*this) == START_NUMBER;
+	}
+
+	bool OnDemandValue::isObject() {
+		return value_start(*this) == START_OBJECT;
+	}
+
+	bool OnDemandValue::isArray() {
+		return value_start(*this) == START_ARRAY;
+	}
+
+	bool OnDemandValue::isBoolean() {
+		return value_start(*this) == START_BOOL;
+	}
+
+	std::string_view OnDemandValue::view() {
+		std::string_view s;
+
+		if (document == nullptr || !document->seek(start, START_STRING)) {
+			return s;
+		}
+
+		document->parser.read_string_view(s);
+
+		if (document->failed()) {
+			return std::string_view();
+		}
+
+		return s;
+	}
+
+	std::string OnDemandValue::string() {
+		return std::string(view());
+	}
+
+	//Scans the number at start, or reports an error and returns an
+	//invalid Number.
+	static Number read_number(OnDemandValue& v) {
+		Number n;
+
+		if (v.document == nullptr || !v.document->seek(v.start, START_NUMBER)) {
+			return n;
+		}
+
+		std::string_view token;
+
+		v.document->parser.read_number_token(token);
+
+		if (v.document->failed()) {
+			return n;
+		}
+
+		n = scan_number(token.data(), token.data() + token.size());
+
+		if (n.type == NUMBER_INVALID || n.type == NUMBER_OUT_OF_RANGE) {
+			v.document->save_error(ERROR_SYNTAX, n.type == NUMBER_INVALID ? "Invalid number." : "Number out of range.");
+		}
+
+		return n;
+	}
+
+	double OnDemandValue::number() {
+		Number n = read_number(*this);
+
+		switch (n.type) {
+		case NUMBER_INT64:
+			return static_cast<double>(n.i);
+		case NUMBER_UINT64:
+			return static_cast<double>(n.u);
+		case NUMBER_DOUBLE:
+			return n.d;
+		default:
+			return 0;
+		}
+	}
+
+	int64_t OnDemandValue::int64() {
+		Number n = read_number(*this);
+
+		if (n.type == NUMBER_INT64) {
+			return n.i;
+		}
+		if (n.type == NUMBER_UINT64 && n.u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+			return static_cast<int64_t>(n.u);
+		}
+		if (n.type == NUMBER_UINT64 || n.type == NUMBER_DOUBLE) {
+			document->save_error(ERROR_INVALID_TYPE, "Number is not a 64 bit integer.");
+		}
+
+		return 0;
+	}
+
+	uint64_t OnDemandValue::uint64() {
+		Number n = read_number(*this);
+
+		if (n.type == NUMBER_UINT64) {
+			return n.u;
+		}
+		if (n.type == NUMBER_INT64 && n.i >= 0) {
+			return static_cast<uint64_t>(n.i);
+		}
+		if (n.type == NUMBER_INT64 || n.type == NUMBER_DOUBLE) {
+			document->save_error(ERROR_INVALID_TYPE, "Number is not an unsigned 64 bit integer.");
+		}
+
+		return 0;
+	}
+
+	bool OnDemandValue::boolean() {
+		if (document == nullptr || !document->seek(start, START_BOOL)) {
+			return false;
+		}
+
+		JSONObject b = document->parser.parse_bool();
+
+		if (document->failed()) {
+			return false;
+		}
+
+		return b.boolean();
+	}
+
+	JSONObject OnDemandValue::materialize() {
+		if (isUndefined()) {
+			return JSONObject();
+		}
+
+		document->reader.location = start;
+
+		JSONObject value = document->parser.parse_value();
+
+		if (document->failed()) {
+			return JSONObject();
+		}
+
+		return value;
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "StringReader.h"
+
+namespace jacc {
+	struct OnDemand;
+
+	/*
+	 A value in an OnDemand document. It only records where the value
+	 starts. Nothing is parsed until a member, an element or the value
+	 itself is asked for, and the values passed on the way are skipped
+	 without being built. A value that does not exist, like a missing
+	 member, is undefined. Reading it, or reading a value as the wrong
+	 type, sets ERROR_INVALID_TYPE on the document and returns 0, false
+	 or an empty string.
+	 */
+	struct OnDemandValue {
+		OnDemand* document = nullptr;
+		//Offset of the first byte of the value in the input
+		size_t start = 0;
+
+		OnDemandValue();
+		OnDemandValue(OnDemand* d, size_t s);
+
+		OnDemandValue operator[](std::string_view name);
+		OnDemandValue operator[](const char* name);
+		OnDemandValue operator[](size_t index);
+		OnDemandValue operator[](int index);
+
+		bool isUndefined();
+		bool isNull();
+		bool isString();
+		bool isNumber();
+		bool isObject();
+		bool isArray();
+		bool isBoolean();
+
+		//Valid until the next string is read from the document when the
+		//string has escapes, otherwise points into the input.
+		std::string_view view();
+		std::string string();
+		double number();
+		int64_t int64();
+		uint64_t uint64();
+		bool boolean();
+
+		//Parses the whole value into a JSONObject
+		JSONObject materialize();
+
+		struct Iterator {
+			OnDemand* document;
+			//Start of the current element, npos at the end
+			size_t position;
+
+			OnDemandValue operator*();
+			Iterator& operator++();
+			bool operator!=(const Iterator& other) const;
+		};
+
+		//Elements of an array, for range based for loops
+		Iterator begin();
+		Iterator end();
+	};
+
+	/*
+	 Pull style access to an in-memory document, StringReader or
+	 MemoryMappedReader input. Chain operator[] like with JSONObject,
+	 for example doc["users"][2]["id"].int64(), and only the path to the
+	 value is scanned. Each lookup scans its object or array from the
+	 start, so iterate arrays with begin() and end() rather than by index.
+	 */
+	struct OnDemand {
+		StringReader& reader;
+		BasicParser<StringReader> parser;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+
+		OnDemand(StringReader& r);
+
+		OnDemandValue root();
+		OnDemandValue operator[](std::string_view name);
+		OnDemandValue operator[](const char* name);
+		OnDemandValue operator[](size_t index);
+		OnDemandValue operator[](int index);
+
+		void save_error(ErrorCode code, const char* msg);
+		bool failed();
+		bool seek(size_t position, uint8_t expected);
+		bool value_follows();
+	};
+}
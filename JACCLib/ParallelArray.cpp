@@ -0,0 +1,148 @@
+#include "ParallelArray.h"
+
+#include <algorithm>
+
+namespace jacc {
+	ParallelArrayParser::ParallelArrayParser(StringReader& r) :
+		ParallelArrayParser(r, ParseOptions(), ParallelOptions()) {
+	}
+
+	ParallelArrayParser::ParallelArrayParser(StringReader& r, const ParseOptions& o, const ParallelOptions& p) :
+		reader(r), options(o), parallel(p) {
+		if (parallel.chunk_size == 0) {
+			parallel.chunk_size = ParallelOptions().chunk_size;
+		}
+	}
+
+	//Of the errors found, keeps the one that comes first in the document
+	void ParallelArrayParser::save_error(ErrorCode code, const char* msg, size_t pos) {
+		if (error_code == ERROR_NONE || pos < offset) {
+			error_code = code;
+			error_message = msg;
+			offset = pos;
+		}
+	}
+
+	JSONObject ParallelArrayParser::parse() {
+		std::string_view data = reader.window();
+
+		error_code = ERROR_NONE;
+		error_message = nullptr;
+		offset = 0;
+
+		if (!index.split_array(data)) {
+			save_error(index.error_code, index.error_message, 0);
+
+			return JSONObject();
+		}
+
+		reader.consume(data.size());
+
+		//Element i is between separators i and i + 1
+		const std::vector<size_t>& separators = index.positions;
+		size_t count = separators.size() - 1;
+		std::pmr::memory_resource* resource = options.resource;
+
+		if (resource == nullptr) {
+			resource = std::pmr::get_default_resource();
+		}
+
+		JSONObject::Array result(resource);
+
+		result.resize(count);
+
+		if (count == 1 && skip_space(data.data() + separators[0] + 1, data.data() + separators[1]) == data.data() + separators[1]) {
+			//[] or [ ]
+			result.clear();
+
+			return JSONObject(result);
+		}
+
+		//Runs of elements of about chunk_size bytes, each a unit of work
+		std::vector<size_t> runs;
+
+		for (size_t i = 0; i < count; ++i) {
+			if (runs.empty() || separators[i] - separators[runs.back()] >= parallel.chunk_size) {
+				runs.push_back(i);
+			}
+		}
+
+		runs.push_back(count);
+
+		size_t threads = parallel.threads != 0 ? parallel.threads : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+		threads = std::max<size_t>(std::min(threads, runs.size() - 1), 1);
+
+		std::atomic<size_t> next(0);
+		std::atomic<bool> stop(false);
+		std::mutex mutex;
+
+		auto work = [&]() {
+			StringReader element_reader;
+			ParseOptions element_options = options;
+
+			//The root array is one level
+			element_options.max_depth = options.max_depth > 0 ? options.max_depth - 1 : 0;
+
+			BasicParser<StringReader> parser(element_reader, element_options);
+
+			while (!stop) {
+				size_t run = next++;
+
+				if (run + 1 >= runs.size()) {
+					break;
+				}
+
+				for (size_t i = runs[run]; i < runs[run + 1]; ++i) {
+					size_t first = separators[i] + 1;
+
+					element_reader.data = data.substr(first, separators[i + 1] - first);
+					element_reader.location = 0;
+					parser.eat_space();
+
+					if (element_reader.location == element_reader.data.size()) {
+						parser.save_error(ERROR_SYNTAX, "Unexpected character.");
+					}
+					else {
+						result[i] = parser.parse_value();
+						parser.eat_space();
+
+						if (parser.error_code == ERROR_NONE && element_reader.location != element_reader.data.size()) {
+							parser.save_error(ERROR_SYNTAX, "Invalid character in array.");
+						}
+					}
+
+					if (parser.error_code != ERROR_NONE) {
+						std::lock_guard<std::mutex> lock(mutex);
+
+						save_error(parser.error_code, parser.error_message, first);
+						stop = true;
+
+						return;
+					}
+				}
+			}
+		};
+
+		if (threads == 1) {
+			work();
+		}
+		else {
+			std::vector<std::thread> workers;
+
+			for (size_t t = 0; t < threads; ++t) {
+				workers.emplace_back(work);
+			}
+
+			for (std::thread& t : workers) {
+				t.join();
+			}
+		}
+
+		if (error_code != ERROR_NONE) {
+			return JSONObject();
+		}
+
+		return JSONObject(result);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "StringReader.h"
+#include "StructuralIndex.h"
+#include "ParallelRecords.h"
+
+namespace jacc {
+	/*
+	 Parses a document that is one big array, like [{...}, {...}, ...],
+	 on several threads. It has to be fully in memory (StringReader and
+	 MemoryMappedReader). A first pass over the input finds the commas
+	 between the elements of the root array (StructuralIndex::split_array),
+	 then threads parse runs of about ParallelOptions::chunk_size bytes of
+	 elements each and place them in the result in document order.
+
+	 The result is returned to the caller and may outlive the parser, so
+	 ParallelOptions::arenas does not apply. Elements come from
+	 ParseOptions::resource, which then has to be thread safe, or from
+	 the heap when it is nullptr. On error offset is where the failing
+	 element starts.
+	 */
+	class ParallelArrayParser
+	{
+	public:
+		StringReader& reader;
+		ParseOptions options;
+		ParallelOptions parallel;
+		StructuralIndex index;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+		size_t offset = 0;
+
+		ParallelArrayParser(StringReader& r);
+		ParallelArrayParser(StringReader& r, const ParseOptions& o, const ParallelOptions& p);
+
+		ParallelArrayParser(const ParallelArrayParser&) = delete;
+		ParallelArrayParser& operator=(const ParallelArrayParser&) = delete;
+
+		void save_error(ErrorCode code, const char* msg, size_t pos);
+		JSONObject parse();
+	};
+}
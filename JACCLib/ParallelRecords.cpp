@@ -0,0 +1,108 @@
+#include "ParallelRecords.h"
+
+#include <algorithm>
+
+namespace jacc {
+	ParallelRecordStream::ParallelRecordStream(StringReader& reader) :
+		ParallelRecordStream(reader, ParseOptions(), ParallelOptions()) {
+	}
+
+	ParallelRecordStream::ParallelRecordStream(StringReader& reader, const ParseOptions& o, const ParallelOptions& p) :
+		data(reader.window()), options(o), parallel(p) {
+		reader.consume(data.size());
+
+		if (parallel.chunk_size == 0) {
+			parallel.chunk_size = ParallelOptions().chunk_size;
+		}
+	}
+
+	size_t ParallelRecordStream::thread_count() const {
+		size_t n = parallel.threads;
+
+		if (n == 0) {
+			n = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		}
+
+		//No point in threads without a chunk to parse
+		return std::max<size_t>(std::min(n, chunk_count()), 1);
+	}
+
+	size_t ParallelRecordStream::chunk_count() const {
+		return (data.size() + parallel.chunk_size - 1) / parallel.chunk_size;
+	}
+
+	//A chunk starts after the first newline at or past its nominal start.
+	//Neighbouring chunks work out the same boundary, so every line is in
+	//exactly one chunk. A line longer than a chunk leaves empty chunks.
+	size_t ParallelRecordStream::boundary(size_t k) const {
+		if (k == 0) {
+			return 0;
+		}
+
+		size_t nominal = k * parallel.chunk_size;
+
+		if (nominal >= data.size()) {
+			return data.size();
+		}
+
+		const char* first = data.data() + nominal - 1;
+		const char* end = static_cast<const char*>(std::memchr(first, '\n', data.size() - nominal + 1));
+
+		return end != nullptr ? end - data.data() + 1 : data.size();
+	}
+
+	std::string_view ParallelRecordStream::chunk(size_t k) const {
+		size_t first = boundary(k);
+		size_t last = boundary(k + 1);
+
+		return data.substr(first, last > first ? last - first : 0);
+	}
+
+	void ParallelRecordStream::make_arenas(size_t n) {
+		if (!parallel.arenas) {
+			return;
+		}
+
+		while (arenas.size() < n) {
+			//One chunk worth of parsed records, usually enough to never grow
+			arenas.push_back(std::make_unique<Arena>(parallel.chunk_size * 2));
+		}
+	}
+
+	std::pmr::memory_resource* ParallelRecordStream::arena_resource(size_t i) {
+		return parallel.arenas ? &arenas[i]->resource : nullptr;
+	}
+
+	void ParallelRecordStream::finish(std::vector<RecordError>& failures) {
+		std::sort(failures.begin(), failures.end(), [](const RecordError& a, const RecordError& b) {
+			return a.offset < b.offset;
+		});
+
+		//Line numbers from one pass over the input up to the last error
+		size_t position = 0;
+		size_t lines = 1;
+
+		for (RecordError& e : failures) {
+			const char* p = data.data() + position;
+			const char* end = data.data() + e.offset;
+
+			while ((p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr) {
+				++lines;
+				++p;
+			}
+
+			position = e.offset;
+			e.line = lines;
+		}
+
+		if (skip_invalid) {
+			errors.insert(errors.end(), failures.begin(), failures.end());
+		}
+		else if (!failures.empty()) {
+			error_code = failures[0].error_code;
+			error_message = failures[0].error_message;
+			offset = failures[0].offset;
+			line = failures[0].line;
+		}
+	}
+}
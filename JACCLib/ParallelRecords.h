@@ -0,0 +1,321 @@
+#pragma once
+
+#include "RecordStream.h"
+#include "Arena.h"
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+
+namespace jacc {
+	struct ParallelOptions {
+		//Worker threads, 0 for one per hardware thread
+		size_t threads = 0;
+		//The input is split into chunks of about this many bytes, each
+		//ending at a newline. A chunk is the unit of work of a thread.
+		size_t chunk_size = 4 * 1024 * 1024;
+		//Parsed chunks that may wait for delivery in order, 0 for twice
+		//the number of threads. Bounds the memory held by results.
+		size_t queue_size = 0;
+		//Parse each chunk into an Arena that is released once its records
+		//have been delivered, so records are only valid during the
+		//callback. Without arenas records use the heap and may be moved
+		//out of the callback. Not used by ParallelArrayParser, whose
+		//result outlives the parse.
+		bool arenas = true;
+	};
+
+	/*
+	 Parses newline delimited JSON that is in memory as a whole, usually a
+	 MemoryMappedReader, on several threads. The input is partitioned at
+	 newlines into chunks that threads take in turn, each with its own
+	 RecordStream and arena, so parsing needs no locking.
+
+	 for_each() calls back on the calling thread with records in input
+	 order. Threads parse at most queue_size chunks ahead of the chunk
+	 being delivered. for_each_unordered() calls back from the worker
+	 threads as records are parsed, concurrently, so the callback must be
+	 thread safe. Both pass the record and its byte offset in the input.
+
+	 ParseOptions apply to every record, except resource, which is
+	 replaced by the per chunk arenas (see ParallelOptions::arenas).
+	 Errors are handled as in RecordStream. Offsets and line numbers of
+	 errors are known once the whole input has been parsed. When a line
+	 stops for_each_unordered(), records from chunks that other threads
+	 are parsing at the time may still be delivered.
+	 */
+	class ParallelRecordStream
+	{
+	public:
+		std::string_view data;
+		ParseOptions options;
+		ParallelOptions parallel;
+		bool skip_invalid = false;
+		//Lines passed over with skip_invalid, in input order
+		std::vector<RecordError> errors;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+		//Where the line that stopped parsing starts, and its line number
+		size_t offset = 0;
+		size_t line = 0;
+
+		//Takes all unread input of reader
+		ParallelRecordStream(StringReader& reader);
+		ParallelRecordStream(StringReader& reader, const ParseOptions& o, const ParallelOptions& p);
+
+		size_t thread_count() const;
+		size_t chunk_count() const;
+		std::string_view chunk(size_t k) const;
+
+		template <typename Callback>
+		bool for_each(Callback callback);
+		template <typename Callback>
+		bool for_each_unordered(Callback callback);
+
+	private:
+		//Start of chunk k
+		size_t boundary(size_t k) const;
+		//Orders errors and works out their line numbers
+		void finish(std::vector<RecordError>& failures);
+
+		//One per slot or thread, kept from call to call and released
+		//after each chunk
+		std::vector<std::unique_ptr<Arena>> arenas;
+
+		//Makes sure there are n arenas when ParallelOptions::arenas is set
+		void make_arenas(size_t n);
+		//Resource of arena i, nullptr for the heap
+		std::pmr::memory_resource* arena_resource(size_t i);
+
+		//Parses chunk k with stream, passing each record and its offset to
+		//on_record. Adds errors to chunk_errors, the one that stopped the
+		//chunk last. Returns false if the chunk was stopped.
+		template <typename OnRecord>
+		bool parse_chunk(RecordStream<StringReader>& stream, size_t k, std::vector<RecordError>& chunk_errors, OnRecord&& on_record) {
+			std::string_view text = chunk(k);
+			size_t base = text.data() - data.data();
+
+			stream.reader.data = text;
+			stream.reader.location = 0;
+			stream.reset();
+			stream.skip_invalid = skip_invalid;
+
+			JSONObject record;
+
+			while (stream.next(record)) {
+				on_record(record, base + stream.offset);
+			}
+
+			for (RecordError& e : stream.errors) {
+				chunk_errors.push_back({ base + e.offset, 0, e.error_code, e.error_message });
+			}
+
+			if (stream.error_code != ERROR_NONE) {
+				chunk_errors.push_back({ base + stream.offset, 0, stream.error_code, stream.error_message });
+
+				return false;
+			}
+
+			return true;
+		}
+	};
+
+	template <typename Callback>
+	bool ParallelRecordStream::for_each(Callback callback) {
+		struct Slot {
+			std::pmr::memory_resource* resource = nullptr;
+			std::vector<JSONObject> records;
+			std::vector<size_t> offsets;
+			std::vector<RecordError> errors;
+			bool ready = false;
+			bool stopped = false;
+		};
+
+		size_t count = chunk_count();
+		size_t queue = parallel.queue_size != 0 ? parallel.queue_size : thread_count() * 2;
+		std::vector<Slot> slots(queue);
+		std::mutex mutex;
+		std::condition_variable parsed, delivered;
+		size_t next = 0;
+		size_t done = 0;
+		bool stop = false;
+
+		make_arenas(queue);
+
+		for (size_t i = 0; i < queue; ++i) {
+			slots[i].resource = arena_resource(i);
+		}
+
+		auto work = [&]() {
+			StringReader reader;
+			RecordStream<StringReader> stream(reader, options);
+
+			for (;;) {
+				size_t k;
+
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+
+					delivered.wait(lock, [&]() {
+						return stop || next >= count || next < done + queue;
+					});
+
+					if (stop || next >= count) {
+						return;
+					}
+
+					k = next++;
+				}
+
+				Slot& slot = slots[k % queue];
+
+				stream.parser.options.resource = slot.resource;
+				slot.stopped = !parse_chunk(stream, k, slot.errors, [&](JSONObject& record, size_t offset) {
+					slot.records.push_back(std::move(record));
+					slot.offsets.push_back(offset);
+				});
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					slot.ready = true;
+				}
+
+				parsed.notify_all();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		std::vector<RecordError> failures;
+		auto join = [&]() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				stop = true;
+			}
+
+			delivered.notify_all();
+
+			for (std::thread& t : threads) {
+				t.join();
+			}
+		};
+
+		for (size_t i = 0; i < thread_count(); ++i) {
+			threads.emplace_back(work);
+		}
+
+		try {
+			while (done < count) {
+				Slot& slot = slots[done % queue];
+
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+
+					parsed.wait(lock, [&]() {
+						return slot.ready;
+					});
+				}
+
+				for (size_t i = 0; i < slot.records.size(); ++i) {
+					callback(slot.records[i], slot.offsets[i]);
+				}
+
+				bool stopped = slot.stopped;
+
+				failures.insert(failures.end(), slot.errors.begin(), slot.errors.end());
+
+				//Records first, their memory may be in the arena
+				slot.records.clear();
+				slot.offsets.clear();
+				slot.errors.clear();
+
+				if (slot.resource != nullptr) {
+					arenas[done % queue]->release();
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					slot.ready = false;
+					++done;
+				}
+
+				delivered.notify_all();
+
+				if (stopped) {
+					break;
+				}
+			}
+		}
+		catch (...) {
+			join();
+
+			throw;
+		}
+
+		join();
+		finish(failures);
+
+		return error_code == ERROR_NONE;
+	}
+
+	template <typename Callback>
+	bool ParallelRecordStream::for_each_unordered(Callback callback) {
+		size_t count = chunk_count();
+		std::atomic<size_t> next(0);
+		std::atomic<bool> stop(false);
+		std::mutex mutex;
+		std::vector<RecordError> failures;
+
+		auto work = [&](size_t thread) {
+			StringReader reader;
+			RecordStream<StringReader> stream(reader, options);
+			std::vector<RecordError> chunk_errors;
+
+			stream.parser.options.resource = arena_resource(thread);
+
+			while (!stop) {
+				size_t k = next++;
+
+				if (k >= count) {
+					break;
+				}
+
+				bool complete = parse_chunk(stream, k, chunk_errors, callback);
+
+				if (stream.parser.options.resource != nullptr) {
+					arenas[thread]->release();
+				}
+
+				if (!chunk_errors.empty()) {
+					std::lock_guard<std::mutex> lock(mutex);
+
+					failures.insert(failures.end(), chunk_errors.begin(), chunk_errors.end());
+					chunk_errors.clear();
+
+					if (!complete) {
+						stop = true;
+					}
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+
+		make_arenas(thread_count());
+
+		for (size_t i = 0; i < thread_count(); ++i) {
+			threads.emplace_back(work, i);
+		}
+
+		for (std::thread& t : threads) {
+			t.join();
+		}
+
+		finish(failures);
+
+		return error_code == ERROR_NONE;
+	}
+}
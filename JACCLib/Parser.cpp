@@ -1,5 +1,7 @@
 #include "Parser.h"
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 
 namespace jacc {
 	JSONObject::JSONObject() : value(jacc::JSON_UNDEFINED()) {
@@ -9,18 +11,66 @@ namespace jacc {
 	JSONObject::JSONObject(std::string& s) : value(std::move(s)) {
 	}
 
+	JSONObject::JSONObject(std::string&& s) : value(std::move(s)) {
+	}
+
 	JSONObject::JSONObject(const char *s) : value(std::string(s)) {
 	}
 
-	JSONObject::JSONObject(std::map<std::string, JSONObject>& o) : value(std::move(o)) {
+	JSONObject::JSONObject(std::string_view s) : value(s) {
+	}
+
+	JSONObject::JSONObject(Object& o) : value(std::move(o)) {
+	}
+
+	JSONObject::JSONObject(Array& a) : value(std::move(a)) {
+	}
+
+	JSONObject::JSONObject(IntArray& a) : value(std::move(a)) {
+	}
+
+	JSONObject::JSONObject(DoubleArray& a) : value(std::move(a)) {
 	}
 
-	JSONObject::JSONObject(std::vector<JSONObject>& a) : value(std::move(a)) {
+	JSONObject::JSONObject(BoolArray& a) : value(std::move(a)) {
+	}
+
+	//Members are moved out of o, which is left empty.
+	JSONObject::JSONObject(std::map<std::string, JSONObject>& o) : value(Object()) {
+		Object& members = object();
+
+		for (auto& member : o) {
+			members.emplace(member.first, std::move(member.second));
+		}
+
+		o.clear();
+	}
+
+	//Elements are moved out of a, which is left empty.
+	JSONObject::JSONObject(std::vector<JSONObject>& a) : value(Array()) {
+		Array& elements = array();
+
+		elements.reserve(a.size());
+
+		for (auto& element : a) {
+			elements.push_back(std::move(element));
+		}
+
+		a.clear();
 	}
 
 	JSONObject::JSONObject(double n) : value(n) {
 	}
 
+	JSONObject::JSONObject(int64_t n) : value(n) {
+	}
+
+	JSONObject::JSONObject(uint64_t n) : value(n) {
+	}
+
+	JSONObject::JSONObject(RawNumber n) : value(n) {
+	}
+
 	JSONObject::JSONObject(bool b) : value(b) {
 	}
 
@@ -28,6 +78,49 @@ namespace jacc {
         other.value = jacc::JSON_UNDEFINED();
 	}
 
+	//Moves the objects and arrays held by container to pending
+	static void take_containers(JSONObject& container, std::vector<JSONObject>& pending) {
+		auto take = [&](JSONObject& child) {
+			if (std::holds_alternative<JSONObject::Object>(child.value) || std::holds_alternative<JSONObject::Array>(child.value)) {
+				pending.push_back(std::move(child));
+			}
+		};
+
+		if (auto o = std::get_if<JSONObject::Object>(&container.value)) {
+			for (auto& member : *o) {
+				take(member.second);
+			}
+		}
+		else if (auto a = std::get_if<JSONObject::Array>(&container.value)) {
+			for (JSONObject& element : *a) {
+				take(element);
+			}
+		}
+	}
+
+	/*
+	 Destroying the variant would destroy nested containers recursively,
+	 one stack frame per level. Instead they are moved out to a list and
+	 destroyed one by one, each after its own nested containers have
+	 been moved out, so the stack use does not depend on the depth.
+	 */
+	JSONObject::~JSONObject() {
+		if (!std::holds_alternative<Object>(value) && !std::holds_alternative<Array>(value)) {
+			return;
+		}
+
+		std::vector<JSONObject> pending;
+
+		take_containers(*this, pending);
+
+		while (!pending.empty()) {
+			JSONObject container = std::move(pending.back());
+
+			pending.pop_back();
+			take_containers(container, pending);
+		}
+	}
+
 	JSONObject& JSONObject::operator=(JSONObject&& other) noexcept {
 		if (this != &other) {
             value = std::move(other.value);
@@ -38,11 +131,23 @@ namespace jacc {
 	}
 
     JSONObject& JSONObject::operator[](const std::string& index) {
-        return object()[index];
+        return (*this)[std::string_view(index)];
     }
 
     JSONObject& JSONObject::operator[](const char* index) {
-        return object()[std::string(index)];
+        return (*this)[std::string_view(index)];
+    }
+
+    //Like std::map, adds an undefined member if there is none by that name.
+    JSONObject& JSONObject::operator[](std::string_view index) {
+        Object& members = object();
+        auto it = members.find(index);
+
+        if (it == members.end()) {
+            it = members.emplace(index, JSONObject()).first;
+        }
+
+        return it->second;
     }
 
     JSONObject& JSONObject::operator[](std::size_t index) {
@@ -70,525 +175,369 @@ namespace jacc {
     }
 
     bool JSONObject::isString() {
-        return std::holds_alternative<std::string>(value);
+        return std::holds_alternative<std::string>(value) || std::holds_alternative<std::string_view>(value);
     }
 
     bool JSONObject::isNumber() {
-        return std::holds_alternative<double>(value);
+        return std::holds_alternative<double>(value) || std::holds_alternative<RawNumber>(value) || isInteger();
+    }
+
+    bool JSONObject::isInteger() {
+        if (auto r = std::get_if<RawNumber>(&value)) {
+            NumberType type = r->convert().type;
+
+            return type == NUMBER_INT64 || type == NUMBER_UINT64;
+        }
+
+        return std::holds_alternative<int64_t>(value) || std::holds_alternative<uint64_t>(value);
     }
 
     bool JSONObject::isObject() {
-        return std::holds_alternative<std::map<std::string, JSONObject>>(value);
+        return std::holds_alternative<Object>(value);
     }
 
     bool JSONObject::isArray() {
-        return std::holds_alternative<std::vector<JSONObject>>(value);
+        return std::holds_alternative<Array>(value) || isPacked();
+    }
+
+    bool JSONObject::isPacked() {
+        return std::holds_alternative<IntArray>(value) || std::holds_alternative<DoubleArray>(value) || std::holds_alternative<BoolArray>(value);
     }
 
     bool JSONObject::isBoolean() {
         return std::holds_alternative<bool>(value);
     }
 
+    /*
+     A string that points into the input is copied into a std::string
+     the first time it is asked for that way. Use view() to avoid the copy.
+     */
     std::string& JSONObject::string() {
+        if (auto v = std::get_if<std::string_view>(&value)) {
+            value = std::string(*v);
+        }
+
         return std::get<std::string>(value);
     }
 
-    double JSONObject::number() {
-        return std::get<double>(value);
-    }
+    std::string_view JSONObject::view() {
+        if (auto v = std::get_if<std::string_view>(&value)) {
+            return *v;
+        }
 
-    std::map<std::string, JSONObject>& JSONObject::object() {
-        return std::get<std::map<std::string, JSONObject>>(value);
+        return std::get<std::string>(value);
     }
 
-    std::vector<JSONObject>& JSONObject::array() {
-        return std::get<std::vector<JSONObject>>(value);
-    }
+    //Integers are converted, which rounds above 2^53. Throws
+    //std::out_of_range for a RawNumber too large for a double.
+    double JSONObject::number() {
+        if (auto r = std::get_if<RawNumber>(&value)) {
+            const Number& n = r->convert();
+
+            switch (n.type) {
+            case NUMBER_INT64:
+                return static_cast<double>(n.i);
+            case NUMBER_UINT64:
+                return static_cast<double>(n.u);
+            case NUMBER_DOUBLE:
+                return n.d;
+            default:
+                throw std::out_of_range("Number out of range.");
+            }
+        }
+        if (auto i = std::get_if<int64_t>(&value)) {
+            return static_cast<double>(*i);
+        }
+        if (auto u = std::get_if<uint64_t>(&value)) {
+            return static_cast<double>(*u);
+        }
 
-    bool JSONObject::boolean() {
-        return std::get<bool>(value);
+        return std::get<double>(value);
     }
 
-	void utf8_encode(std::string& str, unsigned long code_point) {
-		if (code_point <= 0x007F) {
-			char ch = static_cast<char>(code_point);
+    //Throws std::bad_variant_access unless the value is an integer
+    //that fits in an int64_t.
+    int64_t JSONObject::int64() {
+        const uint64_t max = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
 
-			str.push_back(ch);
-		}
-		else if (code_point <= 0x07FF) {
-			uint8_t b2 = 0b10000000 | (code_point & 0b111111);
-			uint8_t b1 = 0b11000000 | (code_point >> 6);
+        if (auto r = std::get_if<RawNumber>(&value)) {
+            const Number& n = r->convert();
 
-			str.push_back(b1);
-			str.push_back(b2);
-		}
-		else if (code_point <= 0xFFFF) {
-			uint8_t b3 = 0b10000000 | (code_point & 0b111111);
-			uint8_t b2 = 0b10000000 | ((code_point >> 6) & 0b111111);
-			uint8_t b1 = 0b11100000 | (code_point >> 12);
+            if (n.type == NUMBER_INT64) {
+                return n.i;
+            }
+            if (n.type == NUMBER_UINT64 && n.u <= max) {
+                return static_cast<int64_t>(n.u);
+            }
 
-			str.push_back(b1);
-			str.push_back(b2);
-			str.push_back(b3);
-		}
-		else if (code_point <= 0x10FFFF) {
-			uint8_t b4 = 0b10000000 | (code_point & 0b111111);
-			uint8_t b3 = 0b10000000 | ((code_point >> 6) & 0b111111);
-			uint8_t b2 = 0b10000000 | ((code_point >> 12) & 0b111111);
-			uint8_t b1 = 0b11110000 | (code_point >> 18);
+            throw std::bad_variant_access();
+        }
+        if (auto u = std::get_if<uint64_t>(&value)) {
+            if (*u > max) {
+                throw std::bad_variant_access();
+            }
 
-			str.push_back(b1);
-			str.push_back(b2);
-			str.push_back(b3);
-			str.push_back(b4);
-		}
-	}
+            return static_cast<int64_t>(*u);
+        }
 
-	Parser::Parser(Reader& r) : reader(r) {
-		value_token.reserve(14);
-	}
+        return std::get<int64_t>(value);
+    }
 
-	JSONObject Parser::parse() {
-		eat_space();
+    //Throws std::bad_variant_access unless the value is a non-negative
+    //integer.
+    uint64_t JSONObject::uint64() {
+        if (auto r = std::get_if<RawNumber>(&value)) {
+            const Number& n = r->convert();
 
-		char ch = peek();
+            if (n.type == NUMBER_UINT64) {
+                return n.u;
+            }
+            if (n.type == NUMBER_INT64 && n.i >= 0) {
+                return static_cast<uint64_t>(n.i);
+            }
 
-		if (ch == '{') {
-			return parse_object();
-		}
-		else if (ch == '[') {
-			return parse_array();
-		}
-		else {
-			save_error(ERROR_SYNTAX, "Document does not start with '{' or '['.");
-		}
-		
-        return JSONObject();
-	}
+            throw std::bad_variant_access();
+        }
+        if (auto i = std::get_if<int64_t>(&value)) {
+            if (*i < 0) {
+                throw std::bad_variant_access();
+            }
 
-	JSONObject Parser::parse_value() {
-		eat_space();
+            return static_cast<uint64_t>(*i);
+        }
 
-		char ch = peek();
+        return std::get<uint64_t>(value);
+    }
 
-		if (ch == 0) {
-			save_error(jacc::ERROR_SYNTAX, "Premature end of documnent while parsing an array.");
+    //Source text of a RawNumber, exactly as it appeared in the document.
+    std::string_view JSONObject::number_text() {
+        return std::get<RawNumber>(value).text;
+    }
 
-			return JSONObject();
-		}
+    JSONObject::Object& JSONObject::object() {
+        return std::get<Object>(value);
+    }
 
-		if (ch == '"') {
-			return parse_string();
-		}
-		else if (ch == '{') {
-			return parse_object();
-		}
-		else if (ch == '[') {
-			return parse_array();
-		}
-		else if (isdigit(ch) || ch == '-') {
-			return parse_number();
-		}
-		else if (ch == 't' || ch == 'f') {
-			return parse_bool();
-		}
-		else if (ch == 'n') {
-			return parse_null();
-		}
-		else {
-			save_error(jacc::ERROR_SYNTAX, "Unexpected character.");
+    //Element is the type the JSONObjects are made from, bool for the
+    //bytes of a BoolArray.
+    template <typename Element, typename Packed>
+    static JSONObject::Array unpack(Packed& packed) {
+        JSONObject::Array elements(packed.get_allocator().resource());
 
-			return JSONObject();
-		}
-	}
+        elements.reserve(packed.size());
 
-	void Parser::read_value_token() {
-		eat_space();
+        for (auto element : packed) {
+            elements.emplace_back(static_cast<Element>(element));
+        }
 
-		value_token.clear();
+        return elements;
+    }
 
-		while (true) {
-			char ch = pop();
+    //A packed array is unpacked into a regular Array in place, so later
+    //calls are cheap but integers(), doubles() and booleans() no longer work.
+    JSONObject::Array& JSONObject::array() {
+        if (auto a = std::get_if<IntArray>(&value)) {
+            value = unpack<int64_t>(*a);
+        }
+        else if (auto a = std::get_if<DoubleArray>(&value)) {
+            value = unpack<double>(*a);
+        }
+        else if (auto a = std::get_if<BoolArray>(&value)) {
+            value = unpack<bool>(*a);
+        }
 
-			if (ch == 0) {
-				save_error(jacc::ERROR_SYNTAX, "Premature end of documnent while parsing a value.");
+        return std::get<Array>(value);
+    }
 
-				return;
-			}
-			if (ch == '}' || ch == ']' || ch == ',') {
-				putback();
+    JSONObject::IntArray& JSONObject::integers() {
+        return std::get<IntArray>(value);
+    }
 
-				break;
-			}
-			else {
-				value_token.push_back(ch);
-			}
-		}
-	}
+    JSONObject::DoubleArray& JSONObject::doubles() {
+        return std::get<DoubleArray>(value);
+    }
 
-	JSONObject Parser::parse_string() {
-		std::string s;
+    JSONObject::BoolArray& JSONObject::booleans() {
+        return std::get<BoolArray>(value);
+    }
 
-		s.reserve(25);
+    bool JSONObject::boolean() {
+        return std::get<bool>(value);
+    }
 
-		read_quoted_string(s);
+	//Largest magnitude up to which every integer is exact as a double
+	static const int64_t EXACT_DOUBLE_INT = int64_t(1) << 53;
 
-		if (error_code != jacc::ERROR_NONE) {
-			return JSONObject();
-		}
-		else {
-			return JSONObject(s);
-		}
+	static bool exact_as_double(int64_t i) {
+		return i >= -EXACT_DOUBLE_INT && i <= EXACT_DOUBLE_INT;
 	}
 
-	void Parser::read_quoted_string(std::string& s) {
-		eat_space();
-
-		char ch = pop();
+	ArrayBuilder::ArrayBuilder(std::pmr::memory_resource* r, bool pack) :
+		mode(pack ? MODE_EMPTY : MODE_GENERIC), list(r), ints(r), doubles(r), bools(r) {
+	}
 
-		if (ch == 0) {
-			save_error(ERROR_SYNTAX, "Premature end of document while parsing string.");
+	void ArrayBuilder::push(JSONObject&& element) {
+		switch (mode) {
+		case MODE_EMPTY:
+			if (auto i = std::get_if<int64_t>(&element.value)) {
+				mode = MODE_INT;
+				ints.push_back(*i);
 
-			return;
-		}
-		else if (ch != '"') {
-			save_error(ERROR_SYNTAX, "String does not start with \".");
+				return;
+			}
+			if (auto d = std::get_if<double>(&element.value)) {
+				mode = MODE_DOUBLE;
+				doubles.push_back(*d);
 
-			return;
-		}
+				return;
+			}
+			if (auto b = std::get_if<bool>(&element.value)) {
+				mode = MODE_BOOL;
+				bools.push_back(*b);
 
-		s.clear();
+				return;
+			}
 
-		while ((ch = pop()) != '"') {
-			if (ch == 0) {
-				save_error(ERROR_SYNTAX, "Premature end of document while parsing string.");
+			break;
+		case MODE_INT:
+			if (auto i = std::get_if<int64_t>(&element.value)) {
+				ints.push_back(*i);
 
 				return;
 			}
+			if (auto d = std::get_if<double>(&element.value)) {
+				bool exact = true;
 
-			if (ch == '\\') {
-				//Escape handling
+				for (int64_t i : ints) {
+					exact = exact && exact_as_double(i);
+				}
 
-				char escaped = pop();
+				if (exact) {
+					//Integers and doubles mixed, store all as doubles
+					mode = MODE_DOUBLE;
+					doubles.reserve(ints.size() * 2);
 
-				if (escaped == 0) {
-					save_error(ERROR_SYNTAX, "Invalid escaped character in string.");
+					for (int64_t i : ints) {
+						doubles.push_back(static_cast<double>(i));
+					}
 
-					return;
-				}
+					doubles.push_back(*d);
+					ints = JSONObject::IntArray(ints.get_allocator());
 
-				if (escaped == 't') {
-					ch = '\t';
-				}
-				else if (escaped == 'r') {
-					ch = '\r';
-				}
-				else if (escaped == 'n') {
-					ch = '\n';
-				}
-				else if (escaped == 'b') {
-					ch = '\b';
-				}
-				else if (escaped == '"') {
-					ch = '"';
-				}
-				else if (escaped == '\\') {
-					ch = '\\';
-				}
-				else if (escaped == 'u') {
-                    /*
-                     JSON Unicode escape basics:
-                     
-                     Code points U+FFFF and below are supplied in JSON as is without any kind of encoding.
-                     The escape must use 4 hex digits after a \u.
-                     Example: code point U+03A9 is escpaed as "\u03A9".
-                     
-                     A code point above U+FFFF is first UTF-16 encoded. This produces two 16 bit integers (called surrogate pairs).
-                     They are then supplied in JSON as two consecutive 4 hex digit integers.
-                     Example: code point U+1D11E is escaped in JSON as "\uD834\uDD1E".
-                     
-                     The first integer in the pair is always in range of (0xD800, 0xDFFF) inclusive.
-                     No valid code point exists in that range. So an integer in that range
-                     signals that this is a leading integer in a UTF-16 encoding.
-                     
-                     See Section 2.5: https://www.ietf.org/rfc/rfc4627.txt
-                     */
-                    
-                    uint16_t i1 = read_codepoint();
-
-					if (error_code != ERROR_NONE) {
-						return;
-					}
-                    
-                    if (i1 >= 0xD800 && i1 <= 0xDFFF) {
-                        //We need to read the next 16 bit
-                        if (pop() != '\\' || pop() != 'u') {
-                            save_error(ERROR_SYNTAX, "Unicode code point above U+FFFF not escaped correctly.");
-                            
-                            return;
-                        } else {
-                            uint16_t i2 = read_codepoint();
-                            
-                            if (error_code != ERROR_NONE) {
-                                return;
-                            }
-                            
-                            unsigned long code_point = decode_utf16(i1, i2);
-
-                            if (error_code != ERROR_NONE) {
-                                return;
-                            }
-                            
-                            utf8_encode(s, code_point);
-                        }
-                    } else {
-                        //Code point is given as is. No need to decode.
-                        utf8_encode(s, i1);
-                    }
-
-					continue;
+					return;
 				}
 			}
 
-			s.push_back(ch);
-		}
-	}
-
-    /*
-     Convert a UTF-16 encoded surrogate pair to code point.
-     Wikipedia does a great job explaing the UTF-16 encoding scheme.
-     https://en.wikipedia.org/wiki/UTF-16#Code_points_from_U+010000_to_U+10FFFF
-     */
-    unsigned long Parser::decode_utf16(uint16_t i1, uint16_t i2) {
-        if (!(i1 >= 0xD800 && i1 <= 0xDFFF) || !(i2 >= 0xDC00 && i2 <= 0xDFFF)) {
-            //Invalid
-            save_error(ERROR_SYNTAX, "Invalid surrogate pair in Unicode escape.");
-            
-            return 0;
-        } else {
-            //Valid
-            i1 = i1 - 0xD800;
-            i2 = i2 - 0xDC00;
-            
-            unsigned long U_ = (i1 << 10) | i2;
-            unsigned long U = U_ + 0x10000;
-            
-            return U;
-        }
-    }
-
-    /*
-     Reads the next 4 characters as a hex integer.
-     */
-    uint16_t Parser::read_codepoint() {
-        char buff[5];
-
-        for (size_t i = 0; i < 4; ++i) {
-            buff[i] = pop();
-            
-            if (buff[i] == '\0') {
-                save_error(ERROR_SYNTAX, "Invalid Unicode escape in string.");
-
-                return 0;
-            }
-        }
-
-        buff[4] = '\0';
-
-        uint16_t code_point = std::strtoul(buff, nullptr, 16);
-        
-        return code_point;
-    }
-
-	JSONObject Parser::parse_object() {
-		char ch = pop();
-
-		if (ch == 0) {
-			save_error(ERROR_SYNTAX, "Premature end of document while parsing string.");
-
-			return JSONObject();
-		}
-		if (ch != '{') {
-			save_error(ERROR_SYNTAX, "Object does not start with '{'.");
+			break;
+		case MODE_DOUBLE:
+			if (auto d = std::get_if<double>(&element.value)) {
+				doubles.push_back(*d);
 
-			return JSONObject();
-		}
-
-		std::map<std::string, JSONObject> map;
-		std::string name;
-
-		name.reserve(25);
-
-		while (true) {
-			eat_space();
-			ch = pop();
-
-			if (ch == 0) {
-				save_error(ERROR_SYNTAX, "Premature end of document while parsing an object.");
-				
-				break;
-			}
-			else if (ch == '}') {
-				//End of object
-				break;
+				return;
 			}
-			else if (ch == '"') {
-				putback();
-				read_quoted_string(name);
+			if (auto i = std::get_if<int64_t>(&element.value)) {
+				if (exact_as_double(*i)) {
+					doubles.push_back(static_cast<double>(*i));
 
-				if (error_code != jacc::ERROR_NONE) {
-					return JSONObject();
+					return;
 				}
 			}
-			else if (ch == ':') {
-				map.emplace(name, parse_value());
 
-				if (error_code != jacc::ERROR_NONE) {
-					return JSONObject();
-				}
-			}
-			else if (ch == ',') {
-				//End of a property. Nothing to do here.
-			}
-			else {
-				save_error(ERROR_SYNTAX, "Invalid character in an object.");
-			}
+			break;
+		case MODE_BOOL:
+			if (auto b = std::get_if<bool>(&element.value)) {
+				bools.push_back(*b);
 
-			if (error_code != ERROR_NONE) {
-				return JSONObject();
+				return;
 			}
-		}
 
-		return JSONObject(map);
-	}
+			break;
+		case MODE_GENERIC:
+			break;
+		}
 
-	JSONObject Parser::parse_number() {
-		read_value_token();
+		unpack();
 
-		if (error_code != jacc::ERROR_NONE) {
-			return JSONObject();
+		if (list.capacity() == 0) {
+			list.reserve(10);
 		}
 
-		double n = std::stod(value_token);
-
-		return JSONObject(n);
+		list.push_back(std::move(element));
 	}
 
-	JSONObject Parser::parse_bool() {
-		read_value_token();
-
-		if (error_code != jacc::ERROR_NONE) {
-			return JSONObject();
+	void ArrayBuilder::unpack() {
+		if (mode == MODE_GENERIC) {
+			return;
 		}
 
-		if (value_token == "true") {
-			return JSONObject(true);
-		} 
-		else if (value_token == "false") {
-			return JSONObject(false);
+		switch (mode) {
+		case MODE_INT:
+			list = jacc::unpack<int64_t>(ints);
+			break;
+		case MODE_DOUBLE:
+			list = jacc::unpack<double>(doubles);
+			break;
+		case MODE_BOOL:
+			list = jacc::unpack<bool>(bools);
+			break;
+		default:
+			break;
 		}
-		else {
-			save_error(ERROR_SYNTAX, "Invalid boolean value.");
 
-			return JSONObject();
-		}
+		mode = MODE_GENERIC;
 	}
 
-	JSONObject Parser::parse_null() {
-		read_value_token();
-
-		if (error_code != jacc::ERROR_NONE) {
-			return JSONObject();
-		}
-
-		if (value_token == "null") {
-			return JSONObject(jacc::JSON_NULL());
-		}
-		else {
-			save_error(ERROR_SYNTAX, "Invalid null value.");
-
-			return JSONObject();
+	JSONObject ArrayBuilder::finish() {
+		switch (mode) {
+		case MODE_INT:
+			return JSONObject(ints);
+		case MODE_DOUBLE:
+			return JSONObject(doubles);
+		case MODE_BOOL:
+			return JSONObject(bools);
+		default:
+			return JSONObject(list);
 		}
 	}
 
-	JSONObject Parser::parse_array() {
-		eat_space();
-
-		char ch = pop();
+	ParseFrame::ParseFrame(bool object, std::pmr::memory_resource* r, bool pack) :
+		is_object(object), members(r), elements(r, pack) {
+	}
 
-		if (ch == 0) {
-			save_error(jacc::ERROR_SYNTAX, "Premature end of documnent while parsing an array.");
+	void utf8_encode(std::string& str, unsigned long code_point) {
+		if (code_point <= 0x007F) {
+			char ch = static_cast<char>(code_point);
 
-			return JSONObject();
+			str.push_back(ch);
 		}
+		else if (code_point <= 0x07FF) {
+			uint8_t b2 = 0b10000000 | (code_point & 0b111111);
+			uint8_t b1 = 0b11000000 | (code_point >> 6);
 
-		if (ch != '[') {
-			save_error(jacc::ERROR_SYNTAX, "JSON array does not start with '['.");
-
-			return JSONObject();
+			str.push_back(b1);
+			str.push_back(b2);
 		}
+		else if (code_point <= 0xFFFF) {
+			uint8_t b3 = 0b10000000 | (code_point & 0b111111);
+			uint8_t b2 = 0b10000000 | ((code_point >> 6) & 0b111111);
+			uint8_t b1 = 0b11100000 | (code_point >> 12);
 
-		std::vector<JSONObject> list;
-
-		list.reserve(10);
-
-		while ((ch = pop()) != ']') {
-			if (ch == 0) {
-				save_error(jacc::ERROR_SYNTAX, "Premature end of documnent while parsing an array.");
-
-				return JSONObject();
-			}
-
-			putback();
-
-			list.push_back(parse_value());
-
-			eat_space();
-
-			//Next character must be ',' or ']'
-			ch = pop();
-
-			if (ch != ',' && ch != ']') {
-				save_error(ERROR_SYNTAX, "Invalid character in array.");
-				//Stop parsing array
-				return JSONObject();
-			}
-			if (ch != ',') {
-				//Next value in array starting
-				putback();
-			}
+			str.push_back(b1);
+			str.push_back(b2);
+			str.push_back(b3);
 		}
+		else if (code_point <= 0x10FFFF) {
+			uint8_t b4 = 0b10000000 | (code_point & 0b111111);
+			uint8_t b3 = 0b10000000 | ((code_point >> 6) & 0b111111);
+			uint8_t b2 = 0b10000000 | ((code_point >> 12) & 0b111111);
+			uint8_t b1 = 0b11110000 | (code_point >> 18);
 
-		return JSONObject(list);
-	}
-
-	char Parser::peek() {
-		return reader.peek();
-	}
-	char Parser::pop() {
-		return reader.pop();
-	}
-
-	void Parser::putback() {
-		reader.putback();
-	}
-
-	void Parser::eat_space() {
-		char ch = pop();
-
-		if (ch == 0) return;
-
-		while (isspace(ch)) {
-			ch = pop();
-
-			if (ch == 0) return;
+			str.push_back(b1);
+			str.push_back(b2);
+			str.push_back(b3);
+			str.push_back(b4);
 		}
-
-		putback();
 	}
 
-	void Parser::save_error(ErrorCode code, const char* msg) {
-		error_code = code;
-		error_message = msg;
-	}
+	template class BasicParser<Reader>;
 }
@@ -5,29 +5,65 @@
 #include <map>
 #include <vector>
 #include <string_view>
+#include <memory_resource>
+#include "ObjectMap.h"
+#include "Number.h"
+#include "Projection.h"
 
 namespace jacc {
 	enum ErrorCode : char {
 		ERROR_NONE,
 		ERROR_INVALID_TYPE,
-		ERROR_SYNTAX
+		ERROR_SYNTAX,
+		ERROR_IO,
+		ERROR_DEPTH
 	};
 
     struct JSON_UNDEFINED{};
     struct JSON_NULL{};
 
 	struct JSONObject {
-        std::variant<JSON_UNDEFINED, JSON_NULL, std::string, double, std::map<std::string, JSONObject>, std::vector<JSONObject>, bool> value;
+        //Containers take their memory from a std::pmr::memory_resource,
+        //see ParseOptions::resource. Members of an Object keep the order
+        //they appear in the document.
+        using Object = ObjectMap<JSONObject>;
+        using Array = std::pmr::vector<JSONObject>;
+        //Packed arrays, see ParseOptions::pack_arrays
+        using IntArray = std::pmr::vector<int64_t>;
+        using DoubleArray = std::pmr::vector<double>;
+        //One byte per boolean, 0 or 1. Unlike std::vector<bool> it is
+        //contiguous and has data().
+        using BoolArray = std::pmr::vector<uint8_t>;
+
+        //A std::string_view is a string that points into the parsed input
+        //instead of owning a copy. See ParseOptions::zero_copy.
+        //Integers that fit in 64 bits are stored exactly as int64_t, or
+        //uint64_t when above INT64_MAX. Other numbers are double. A
+        //RawNumber is a number that is converted when first read, see
+        //ParseOptions::lazy_numbers.
+        std::variant<JSON_UNDEFINED, JSON_NULL, std::string, double, Object, Array, bool, std::string_view, int64_t, uint64_t, RawNumber, IntArray, DoubleArray, BoolArray> value;
 		
 		JSONObject();
         JSONObject(JSON_NULL n);
 		JSONObject(std::string& s);
+		JSONObject(std::string&& s);
 		JSONObject(const char* s);
+		JSONObject(std::string_view s);
+		JSONObject(Object& o);
+		JSONObject(Array& a);
+		JSONObject(IntArray& a);
+		JSONObject(DoubleArray& a);
+		JSONObject(BoolArray& a);
 		JSONObject(std::map<std::string, JSONObject>& o);
 		JSONObject(std::vector<JSONObject>& a);
 		JSONObject(double n);
+		JSONObject(int64_t n);
+		JSONObject(uint64_t n);
+		JSONObject(RawNumber n);
 		JSONObject(bool b);
 		JSONObject(JSONObject&& other) noexcept;
+		//Not recursive, see ParseOptions::max_depth
+		~JSONObject();
 
 		//Disable any copying. Deep copying can be very
 		//expensive for a nested class like JSONObject.
@@ -38,6 +74,7 @@ namespace jacc {
         
         JSONObject& operator[](const std::string& index);
         JSONObject& operator[](const char* index);
+        JSONObject& operator[](std::string_view index);
         JSONObject& operator[](std::size_t index);
         JSONObject& operator[](int index);
         
@@ -49,52 +86,243 @@ namespace jacc {
         bool isNull();
         bool isString();
         bool isNumber();
+        bool isInteger();
         bool isObject();
         bool isArray();
+        bool isPacked();
         bool isBoolean();
         
         std::string& string();
+        std::string_view view();
         double number();
-        std::map<std::string, JSONObject>& object();
-        std::vector<JSONObject>& array();
+        int64_t int64();
+        uint64_t uint64();
+        std::string_view number_text();
+        Object& object();
+        Array& array();
+        IntArray& integers();
+        DoubleArray& doubles();
+        BoolArray& booleans();
         bool boolean();
 	};
 	
+	struct ParseOptions {
+		/*
+		 Store strings without escapes as std::string_view pointing into
+		 the input instead of copying them. Only applies to readers whose
+		 data stays in memory (see Reader::persistent()), and the input must
+		 outlive the parsed values. Object keys are still copied.
+		 */
+		bool zero_copy = false;
+
+		/*
+		 Where objects, arrays, keys and strings of the parsed tree get their
+		 memory. With a resource set, strings are copied into it and stored
+		 as std::string_view, so a whole document can live in one Arena.
+		 The resource must outlive the tree. nullptr means regular heap
+		 allocation.
+		 */
+		std::pmr::memory_resource* resource = nullptr;
+
+		/*
+		 Keep numbers as their source text (RawNumber) and convert them only
+		 when number(), int64() or uint64() is first called. The grammar is
+		 still checked while parsing. The text is referenced in the input
+		 when the reader is persistent, otherwise it is copied into resource.
+		 With neither available numbers are converted right away.
+		 number_text() returns the exact text for lossless output.
+		 */
+		bool lazy_numbers = false;
+
+		/*
+		 Store arrays that hold only integers, only numbers or only booleans
+		 as one contiguous IntArray, DoubleArray or BoolArray instead of a
+		 JSONObject per element. Read them through integers(), doubles() and
+		 booleans(). isArray() is true for them, and array() or an index
+		 unpacks them into a regular Array first. Integers in a DoubleArray
+		 become doubles, so only arrays with integers up to 2^53 are packed
+		 that way.
+		 */
+		bool pack_arrays = false;
+
+		/*
+		 Deepest nesting of objects and arrays accepted. Deeper input fails
+		 with ERROR_DEPTH as soon as the limit is crossed. parse() keeps
+		 open containers on a heap allocated stack and JSONObject is
+		 destroyed without recursing, so there the limit protects memory
+		 and time. The event API and IndexedParser recurse once per level,
+		 so for them it also protects the thread's stack. Code that walks
+		 a tree recursively should keep it well below the stack size.
+		 PushParser applies the same limit to its container stack.
+		 */
+		size_t max_depth = 1024;
+
+		/*
+		 Build only the parts of the document selected by these paths.
+		 Everything else is skipped without being decoded or allocated,
+		 and only checked as far as needed to find where it ends (see
+		 BasicParser::skip_value()). Objects and arrays on the way to a
+		 selected value are kept, even if nothing in them matched. The
+		 paths are relative to the value parse_value() reads, so with
+		 RecordStream, ArrayStream and ParallelArrayParser to each record
+		 or element. Not used by the event API or IndexedParser.
+		 */
+		const Projection* projection = nullptr;
+	};
+
+	/*
+	 Collects array elements while an array is parsed and packs them when
+	 ParseOptions::pack_arrays is set. Starts out packed based on the first
+	 element and falls back to a regular Array at the first element that
+	 does not fit.
+	 */
+	struct ArrayBuilder {
+		enum Mode : char {
+			MODE_EMPTY,
+			MODE_INT,
+			MODE_DOUBLE,
+			MODE_BOOL,
+			MODE_GENERIC
+		};
+
+		Mode mode;
+		JSONObject::Array list;
+		JSONObject::IntArray ints;
+		JSONObject::DoubleArray doubles;
+		JSONObject::BoolArray bools;
+
+		ArrayBuilder(std::pmr::memory_resource* r, bool pack);
+		void push(JSONObject&& element);
+		void unpack();
+		JSONObject finish();
+	};
+
+	//An object or array that is being parsed, see BasicParser::frames
+	struct ParseFrame {
+		bool is_object;
+		JSONObject::Object members;
+		ArrayBuilder elements;
+		//Name of the member being parsed
+		std::string key;
+		//Position of the element being parsed, counting skipped ones
+		size_t index = 0;
+		//Where the container is in ParseOptions::projection
+		uint32_t node = Projection::ALL;
+
+		ParseFrame(bool object, std::pmr::memory_resource* r, bool pack);
+	};
+
 	struct Reader
 	{
 		virtual char peek() = 0;
 		virtual char pop() = 0;
 		virtual void putback() = 0;
+
+		/*
+		 Bulk access. window() returns the unread bytes that are available
+		 right now as one contiguous block, and consume() moves past the first
+		 n of them. An empty window means the input is exhausted or the reader
+		 only supports character at a time access. Bytes inside a window are
+		 data, so an embedded '\0' there is not mistaken for the end of input.
+		 */
+		virtual std::string_view window() {
+			return {};
+		}
+
+		virtual void consume(size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				pop();
+			}
+		}
+
+		//True if bytes returned by window() stay valid and unchanged for
+		//the life of the reader, so parsed values can point into them.
+		virtual bool persistent() {
+			return false;
+		}
+
 		virtual ~Reader() {};
 	};
 
-	class Parser
+	/*
+	 The parser is a template over the reader type. When ReaderT is a concrete
+	 reader like StringReader the peek(), pop() and putback() calls are bound
+	 at compile time and can be inlined into the scanning loops. Use
+	 Parser (BasicParser<Reader>) when the reader type is only known at run time.
+	 */
+	template <typename ReaderT>
+	class BasicParser
 	{
 	public:
-		Reader& reader;
+		ReaderT& reader;
+		ParseOptions options;
 		ErrorCode error_code = ERROR_NONE;
 		const char* error_message = nullptr;
 		std::string value_token;
+		//Reused when strings are decoded before being copied into options.resource
+		std::string string_token;
+		//Objects and arrays that are open, innermost last. Kept between
+		//parses so its memory is reused.
+		std::vector<ParseFrame> frames;
+		//Objects and arrays open in the event API, which recurses
+		size_t depth = 0;
 
-		Parser(Reader& r);
+		BasicParser(ReaderT& r);
+		BasicParser(ReaderT& r, const ParseOptions& o);
 		char peek();
 		char pop();
 		void putback();
 		void eat_space();
 		void read_value_token();
+		bool read_number_token(std::string_view& token);
 		void read_quoted_string(std::string& s);
+		void read_string_run(std::string& s);
 		void save_error(ErrorCode code, const char* msg);
         uint16_t read_codepoint();
         unsigned long decode_utf16(uint16_t i1, uint16_t i2);
         JSONObject parse();
 		JSONObject parse_value();
+		JSONObject parse_object();
 		JSONObject parse_array();
+		JSONObject parse_scalar(uint8_t start);
+		bool open_container(bool is_object, uint32_t node);
+		uint32_t child_node(const ParseFrame& frame);
+		bool read_member_name(ParseFrame& frame);
+		JSONObject close_container();
 		JSONObject parse_string();
-		JSONObject parse_object();
+		JSONObject make_string(std::string& s);
+		JSONObject make_number(const char* first, const char* last, bool persistent);
+		std::pmr::memory_resource* resource();
 		JSONObject parse_number();
 		JSONObject parse_bool();
 		JSONObject parse_null();
+		void skip_value();
+		void skip_string();
+		void skip_string_tail(bool escaped);
+
+		/*
+		 Event API. Reports the document to handler as it is read instead of
+		 building a tree, see SaxHandler for the callbacks. The handler type
+		 is a template argument, so the calls can be inlined. Strings and keys
+		 are passed as views that are only valid during the callback.
+		 */
+		template <typename Handler>
+		void parse(Handler& handler);
+		template <typename Handler>
+		void parse_value(Handler& handler);
+		template <typename Handler>
+		void parse_object(Handler& handler);
+		template <typename Handler>
+		void parse_array(Handler& handler);
+		template <typename Handler>
+		void parse_number(Handler& handler);
+		bool read_string_view(std::string_view& s);
 	};
-}
 
+	//Works with any Reader through virtual calls.
+	using Parser = BasicParser<Reader>;
+
+	void utf8_encode(std::string& str, unsigned long code_point);
+}
 
+#include "ParserImpl.h"
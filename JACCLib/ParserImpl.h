@@ -0,0 +1,1238 @@
+#pragma once
+
+//Definitions of the BasicParser template. Included by Parser.h.
+
+#include "Scanner.h"
+#include "Number.h"
+
+#include <cstring>
+
+namespace jacc {
+	template <typename ReaderT>
+	BasicParser<ReaderT>::BasicParser(ReaderT& r) : reader(r) {
+		value_token.reserve(14);
+	}
+
+	template <typename ReaderT>
+	BasicParser<ReaderT>::BasicParser(ReaderT& r, const ParseOptions& o) : reader(r), options(o) {
+		value_token.reserve(14);
+	}
+
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::parse() {
+		eat_space();
+
+		char ch = peek();
+
+		if (ch == '{' || ch == '[') {
+			return parse_value();
+		}
+		else {
+			save_error(ERROR_SYNTAX, "Document does not start with '{' or '['.");
+		}
+		
+        return JSONObject();
+	}
+
+	//Parses the object at the current position
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::parse_object() {
+		eat_space();
+
+		char ch = peek();
+
+		if (ch != '{') {
+			save_error(ERROR_SYNTAX, ch == 0 ? "Premature end of document while parsing an object." : "Object does not start with '{'.");
+
+			return JSONObject();
+		}
+
+		return parse_value();
+	}
+
+	//Parses the array at the current position
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::parse_array() {
+		eat_space();
+
+		char ch = peek();
+
+		if (ch != '[') {
+			save_error(ERROR_SYNTAX, ch == 0 ? "Premature end of documnent while parsing an array." : "JSON array does not start with '['.");
+
+			return JSONObject();
+		}
+
+		return parse_value();
+	}
+
+	/*
+	 Parses objects and arrays without recursion. Each open container is a
+	 ParseFrame on the frames stack. A finished value is added to the
+	 frame on top, and a finished container is popped and becomes the
+	 value added to the one below it. Values that ParseOptions::projection
+	 does not select are skipped instead.
+	 */
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::parse_value() {
+		eat_space();
+
+		uint8_t start = VALUE_START[static_cast<unsigned char>(peek())];
+		//Where the value is in the projection
+		uint32_t node = options.projection != nullptr ? options.projection->root() : Projection::ALL;
+
+		if (start != START_OBJECT && start != START_ARRAY) {
+			if (node != Projection::ALL) {
+				skip_value();
+
+				return JSONObject();
+			}
+
+			return parse_scalar(start);
+		}
+
+		size_t base = frames.size();
+		JSONObject value;
+
+		while (true) {
+			bool skipped = false;
+
+			//At the start of a value
+			if (node != Projection::ALL && (node == Projection::NONE || (start != START_OBJECT && start != START_ARRAY))) {
+				//Not selected, or a scalar where the paths go deeper
+				skip_value();
+
+				if (error_code != ERROR_NONE) {
+					break;
+				}
+
+				skipped = true;
+			}
+			else if (start == START_OBJECT || start == START_ARRAY) {
+				if (!open_container(start == START_OBJECT, node)) {
+					break;
+				}
+
+				ParseFrame& frame = frames.back();
+
+				eat_space();
+
+				if (peek() == (frame.is_object ? '}' : ']')) {
+					pop();
+					value = close_container();
+				}
+				else {
+					if (frame.is_object && !read_member_name(frame)) {
+						break;
+					}
+
+					eat_space();
+					start = VALUE_START[static_cast<unsigned char>(peek())];
+					node = child_node(frame);
+
+					continue;
+				}
+			}
+			else {
+				value = parse_scalar(start);
+
+				if (error_code != ERROR_NONE) {
+					break;
+				}
+			}
+
+			//A value is complete. Add it to its container, closing
+			//containers that end with it.
+			while (frames.size() > base) {
+				ParseFrame& frame = frames.back();
+
+				if (skipped) {
+					skipped = false;
+				}
+				else if (frame.is_object) {
+					frame.members.emplace(std::string_view(frame.key), std::move(value));
+				}
+				else {
+					frame.elements.push(std::move(value));
+				}
+
+				++frame.index;
+				eat_space();
+
+				char ch = pop();
+
+				if (ch == ',') {
+					if (frame.is_object && !read_member_name(frame)) {
+						break;
+					}
+
+					eat_space();
+					start = VALUE_START[static_cast<unsigned char>(peek())];
+					node = child_node(frame);
+
+					break;
+				}
+				else if (ch == (frame.is_object ? '}' : ']')) {
+					value = close_container();
+				}
+				else if (ch == 0) {
+					save_error(ERROR_SYNTAX, frame.is_object ? "Premature end of document while parsing an object." : "Premature end of documnent while parsing an array.");
+
+					break;
+				}
+				else {
+					save_error(ERROR_SYNTAX, frame.is_object ? "Invalid character in an object." : "Invalid character in array.");
+
+					break;
+				}
+			}
+
+			if (error_code != ERROR_NONE) {
+				break;
+			}
+
+			if (frames.size() == base) {
+				return value;
+			}
+		}
+
+		//Failed, drop the containers this call opened
+		frames.erase(frames.begin() + base, frames.end());
+
+		return JSONObject();
+	}
+
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::parse_scalar(uint8_t start) {
+		switch (start) {
+		case START_STRING:
+			return parse_string();
+		case START_NUMBER:
+			return parse_number();
+		case START_BOOL:
+			return parse_bool();
+		case START_NULL:
+			return parse_null();
+		case START_END:
+			save_error(jacc::ERROR_SYNTAX, "Premature end of documnent while parsing an array.");
+
+			return JSONObject();
+		default:
+			save_error(jacc::ERROR_SYNTAX, "Unexpected character.");
+
+			return JSONObject();
+		}
+	}
+
+	//Consumes the '{' or '[' and pushes a frame for it.
+	template <typename ReaderT>
+	bool BasicParser<ReaderT>::open_container(bool is_object, uint32_t node) {
+		if (frames.size() >= options.max_depth) {
+			save_error(ERROR_DEPTH, "Document is nested too deeply.");
+
+			return false;
+		}
+
+		pop();
+		frames.emplace_back(is_object, resource(), options.pack_arrays);
+		frames.back().node = node;
+
+		return true;
+	}
+
+	//Where the member or element about to be parsed is in the projection.
+	template <typename ReaderT>
+	uint32_t BasicParser<ReaderT>::child_node(const ParseFrame& frame) {
+		if (frame.node == Projection::ALL) {
+			return Projection::ALL;
+		}
+
+		return frame.is_object ? options.projection->member(frame.node, frame.key) : options.projection->element(frame.node, frame.index);
+	}
+
+	//Reads a member name and the ':' after it into frame.key.
+	template <typename ReaderT>
+	bool BasicParser<ReaderT>::read_member_name(ParseFrame& frame) {
+		eat_space();
+
+		char ch = peek();
+
+		if (ch != '"') {
+			save_error(ERROR_SYNTAX, ch == 0 ? "Premature end of document while parsing an object." : "Invalid character in an object.");
+
+			return false;
+		}
+
+		read_quoted_string(frame.key);
+
+		if (error_code != ERROR_NONE) {
+			return false;
+		}
+
+		eat_space();
+
+		if (pop() != ':') {
+			save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+			return false;
+		}
+
+		return true;
+	}
+
+	//Pops the innermost container, its closing character already consumed.
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::close_container() {
+		ParseFrame& frame = frames.back();
+		JSONObject value = frame.is_object ? JSONObject(frame.members) : frame.elements.finish();
+
+		frames.pop_back();
+
+		return value;
+	}
+
+	template <typename ReaderT>
+	void BasicParser<ReaderT>::read_value_token() {
+		eat_space();
+
+		value_token.clear();
+
+		while (true) {
+			std::string_view w = reader.window();
+
+			if (!w.empty()) {
+				const char* end = w.data() + w.size();
+				const char* stop = find_token_end(w.data(), end);
+				size_t count = stop - w.data();
+
+				value_token.append(w.data(), count);
+				reader.consume(count);
+
+				if (stop != end) {
+					//Stopped at the end of the token
+					break;
+				}
+
+				continue;
+			}
+
+			char ch = pop();
+
+			if (ch == 0) {
+				if (!value_token.empty()) {
+					//The input ends with the token, as with a scalar record
+					//(see RecordStream). A truncated container is reported
+					//by its caller.
+					break;
+				}
+
+				save_error(jacc::ERROR_SYNTAX, "Premature end of documnent while parsing a value.");
+
+				return;
+			}
+			if (CHAR_CLASS[static_cast<unsigned char>(ch)] & CHAR_TOKEN_END) {
+				putback();
+
+				break;
+			}
+			else {
+				value_token.push_back(ch);
+			}
+		}
+	}
+
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::parse_string() {
+		if (options.zero_copy && reader.persistent()) {
+			eat_space();
+
+			std::string_view w = reader.window();
+
+			if (!w.empty() && w[0] == '"') {
+				const char* end = w.data() + w.size();
+				const char* stop = find_string_special(w.data() + 1, end);
+
+				if (stop != end && *stop == '"') {
+					//No escapes. Point straight into the input.
+					reader.consume(stop - w.data() + 1);
+
+					return JSONObject(std::string_view(w.data() + 1, stop - w.data() - 1));
+				}
+			}
+
+			//Has escapes or is malformed. Decode it the regular way.
+		}
+
+		if (options.resource != nullptr) {
+			//The decoded bytes get copied into the resource,
+			//so decode into a reused buffer.
+			read_quoted_string(string_token);
+
+			if (error_code != jacc::ERROR_NONE) {
+				return JSONObject();
+			}
+
+			return make_string(string_token);
+		}
+
+		std::string s;
+
+		s.reserve(25);
+
+		read_quoted_string(s);
+
+		if (error_code != jacc::ERROR_NONE) {
+			return JSONObject();
+		}
+		else {
+			return make_string(s);
+		}
+	}
+
+	/*
+	 Wraps a decoded string. With a memory resource the bytes are copied
+	 into it and referenced through a view, otherwise s is moved into the
+	 result. The copy is never deallocated on its own, so the resource
+	 should be an arena that is released as a whole.
+	 */
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::make_string(std::string& s) {
+		if (options.resource == nullptr) {
+			return JSONObject(s);
+		}
+
+		if (s.empty()) {
+			return JSONObject(std::string_view());
+		}
+
+		char* copy = static_cast<char*>(options.resource->allocate(s.size(), 1));
+
+		std::memcpy(copy, s.data(), s.size());
+
+		return JSONObject(std::string_view(copy, s.size()));
+	}
+
+	//Wraps the text of a number that has already been validated, copying
+	//it into the memory resource unless it stays valid in the input.
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::make_number(const char* first, const char* last, bool persistent) {
+		RawNumber n;
+		size_t size = last - first;
+
+		if (persistent) {
+			n.text = std::string_view(first, size);
+		}
+		else {
+			char* copy = static_cast<char*>(options.resource->allocate(size, 1));
+
+			std::memcpy(copy, first, size);
+			n.text = std::string_view(copy, size);
+		}
+
+		return JSONObject(n);
+	}
+
+	template <typename ReaderT>
+	std::pmr::memory_resource* BasicParser<ReaderT>::resource() {
+		return options.resource != nullptr ? options.resource : std::pmr::get_default_resource();
+	}
+
+	template <typename ReaderT>
+	void BasicParser<ReaderT>::read_quoted_string(std::string& s) {
+		eat_space();
+
+		char ch = pop();
+
+		if (ch == 0) {
+			save_error(ERROR_SYNTAX, "Premature end of document while parsing string.");
+
+			return;
+		}
+		else if (ch != '"') {
+			save_error(ERROR_SYNTAX, "String does not start with \".");
+
+			return;
+		}
+
+		s.clear();
+
+		while (true) {
+			read_string_run(s);
+
+			if (error_code != ERROR_NONE) {
+				return;
+			}
+
+			if ((ch = pop()) == '"') {
+				break;
+			}
+
+			if (ch == 0) {
+				save_error(ERROR_SYNTAX, "Premature end of document while parsing string.");
+
+				return;
+			}
+
+			if (static_cast<unsigned char>(ch) < 0x20) {
+				save_error(ERROR_SYNTAX, "Unescaped control character in string.");
+
+				return;
+			}
+
+			if (ch == '\\') {
+				//Escape handling
+
+				char escaped = pop();
+
+				if (escaped == 'u') {
+                    /*
+                     JSON Unicode escape basics:
+                     
+                     Code points U+FFFF and below are supplied in JSON as is without any kind of encoding.
+                     The escape must use 4 hex digits after a \u.
+                     Example: code point U+03A9 is escpaed as "\u03A9".
+                     
+                     A code point above U+FFFF is first UTF-16 encoded. This produces two 16 bit integers (called surrogate pairs).
+                     They are then supplied in JSON as two consecutive 4 hex digit integers.
+                     Example: code point U+1D11E is escaped in JSON as "\uD834\uDD1E".
+                     
+                     The first integer in the pair is always in range of (0xD800, 0xDFFF) inclusive.
+                     No valid code point exists in that range. So an integer in that range
+                     signals that this is a leading integer in a UTF-16 encoding.
+                     
+                     See Section 2.5: https://www.ietf.org/rfc/rfc4627.txt
+                     */
+                    
+                    uint16_t i1 = read_codepoint();
+
+					if (error_code != ERROR_NONE) {
+						return;
+					}
+                    
+                    if (i1 >= 0xD800 && i1 <= 0xDFFF) {
+                        //We need to read the next 16 bit
+                        if (pop() != '\\' || pop() != 'u') {
+                            save_error(ERROR_SYNTAX, "Unicode code point above U+FFFF not escaped correctly.");
+                            
+                            return;
+                        } else {
+                            uint16_t i2 = read_codepoint();
+                            
+                            if (error_code != ERROR_NONE) {
+                                return;
+                            }
+                            
+                            unsigned long code_point = decode_utf16(i1, i2);
+
+                            if (error_code != ERROR_NONE) {
+                                return;
+                            }
+                            
+                            utf8_encode(s, code_point);
+                        }
+                    } else {
+                        //Code point is given as is. No need to decode.
+                        utf8_encode(s, i1);
+                    }
+
+					continue;
+				}
+
+				ch = ESCAPE_CHAR[static_cast<unsigned char>(escaped)];
+
+				if (ch == 0) {
+					save_error(ERROR_SYNTAX, "Invalid escaped character in string.");
+
+					return;
+				}
+			}
+
+			s.push_back(ch);
+		}
+	}
+
+	/*
+	 Appends to s the bytes in the reader's window up to the next '"', '\\'
+	 or control character. Those are the only characters that need to be
+	 looked at one by one.
+	 */
+	template <typename ReaderT>
+	void BasicParser<ReaderT>::read_string_run(std::string& s) {
+		while (true) {
+			std::string_view w = reader.window();
+
+			if (w.empty()) {
+				return;
+			}
+
+			const char* end = w.data() + w.size();
+			const char* stop = find_string_special(w.data(), end);
+			size_t count = stop - w.data();
+
+			s.append(w.data(), count);
+			reader.consume(count);
+
+			if (stop != end) {
+				if (static_cast<unsigned char>(*stop) < 0x20) {
+					save_error(ERROR_SYNTAX, "Unescaped control character in string.");
+				}
+
+				return;
+			}
+		}
+	}
+
+    /*
+     Convert a UTF-16 encoded surrogate pair to code point.
+     Wikipedia does a great job explaing the UTF-16 encoding scheme.
+     https://en.wikipedia.org/wiki/UTF-16#Code_points_from_U+010000_to_U+10FFFF
+     */
+    template <typename ReaderT>
+    unsigned long BasicParser<ReaderT>::decode_utf16(uint16_t i1, uint16_t i2) {
+        if (!(i1 >= 0xD800 && i1 <= 0xDFFF) || !(i2 >= 0xDC00 && i2 <= 0xDFFF)) {
+            //Invalid
+            save_error(ERROR_SYNTAX, "Invalid surrogate pair in Unicode escape.");
+            
+            return 0;
+        } else {
+            //Valid
+            i1 = i1 - 0xD800;
+            i2 = i2 - 0xDC00;
+            
+            unsigned long U_ = (i1 << 10) | i2;
+            unsigned long U = U_ + 0x10000;
+            
+            return U;
+        }
+    }
+
+    /*
+     Reads the next 4 characters as a hex integer.
+     */
+    template <typename ReaderT>
+    uint16_t BasicParser<ReaderT>::read_codepoint() {
+        std::string_view w = reader.window();
+        uint16_t code_point = 0;
+
+        for (size_t i = 0; i < 4; ++i) {
+            char ch = w.size() >= 4 ? w[i] : pop();
+            uint8_t digit = HEX_DIGIT[static_cast<unsigned char>(ch)];
+
+            if (digit == 0xFF) {
+                save_error(ERROR_SYNTAX, "Invalid Unicode escape in string.");
+
+                return 0;
+            }
+
+            code_point = (code_point << 4) | digit;
+        }
+
+        if (w.size() >= 4) {
+            reader.consume(4);
+        }
+
+        return code_point;
+    }
+
+	template <typename ReaderT>
+	bool BasicParser<ReaderT>::read_number_token(std::string_view& token) {
+		eat_space();
+
+		std::string_view w = reader.window();
+
+		if (!w.empty()) {
+			const char* end = w.data() + w.size();
+			const char* last = find_token_end(w.data(), end);
+
+			//Unless the number may continue past the window
+			if (last != end) {
+				token = std::string_view(w.data(), last - w.data());
+				reader.consume(token.size());
+
+				return true;
+			}
+		}
+
+		read_value_token();
+		token = value_token;
+
+		return false;
+	}
+
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::parse_number() {
+		std::string_view token;
+		bool in_window = read_number_token(token);
+
+		if (error_code != jacc::ERROR_NONE) {
+			return JSONObject();
+		}
+
+		const char* first = token.data();
+		const char* last = first + token.size();
+
+		if (options.lazy_numbers) {
+			bool persistent = in_window && reader.persistent();
+
+			if (persistent || options.resource != nullptr) {
+				if (!valid_number(first, last)) {
+					save_error(ERROR_SYNTAX, "Invalid number.");
+
+					return JSONObject();
+				}
+
+				return make_number(first, last, persistent);
+			}
+		}
+
+		Number n = scan_number(first, last);
+
+		switch (n.type) {
+		case NUMBER_INT64:
+			return JSONObject(n.i);
+		case NUMBER_UINT64:
+			return JSONObject(n.u);
+		case NUMBER_DOUBLE:
+			return JSONObject(n.d);
+		case NUMBER_OUT_OF_RANGE:
+			save_error(ERROR_SYNTAX, "Number out of range.");
+
+			return JSONObject();
+		default:
+			save_error(ERROR_SYNTAX, "Invalid number.");
+
+			return JSONObject();
+		}
+	}
+
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::parse_bool() {
+		read_value_token();
+
+		if (error_code != jacc::ERROR_NONE) {
+			return JSONObject();
+		}
+
+		if (value_token == "true") {
+			return JSONObject(true);
+		} 
+		else if (value_token == "false") {
+			return JSONObject(false);
+		}
+		else {
+			save_error(ERROR_SYNTAX, "Invalid boolean value.");
+
+			return JSONObject();
+		}
+	}
+
+	template <typename ReaderT>
+	JSONObject BasicParser<ReaderT>::parse_null() {
+		read_value_token();
+
+		if (error_code != jacc::ERROR_NONE) {
+			return JSONObject();
+		}
+
+		if (value_token == "null") {
+			return JSONObject(jacc::JSON_NULL());
+		}
+		else {
+			save_error(ERROR_SYNTAX, "Invalid null value.");
+
+			return JSONObject();
+		}
+	}
+
+	/*
+	 Moves past the next value without building it. Strings are skipped
+	 with the vectorized string scan and containers by counting brackets
+	 until the matching close. Brackets are found 64 bytes at a time with
+	 the same block classification as StructuralIndex, which also tells
+	 which of them are in strings, as long as the reader's window holds
+	 whole blocks. The value is only checked as far as needed to find its
+	 end, so for example a mismatched bracket inside it or a malformed
+	 number is not reported.
+	 */
+	template <typename ReaderT>
+	void BasicParser<ReaderT>::skip_value() {
+		eat_space();
+
+		char ch = peek();
+
+		if (ch == '"') {
+			skip_string();
+
+			return;
+		}
+
+		if (ch != '{' && ch != '[') {
+			std::string_view token;
+
+			read_number_token(token);
+
+			if (error_code == ERROR_NONE && token.empty()) {
+				save_error(ERROR_SYNTAX, "Unexpected character.");
+			}
+
+			return;
+		}
+
+		size_t depth = 0;
+
+		while (true) {
+			std::string_view w = reader.window();
+			const char* p = w.data();
+			const char* end = p + w.size();
+
+			//Whole 64 byte blocks are classified at once and only their
+			//brackets outside of strings looked at
+			uint64_t open_escape = 0;
+			uint64_t prev_in_string = 0;
+
+			for (; end - p >= 64; p += 64) {
+				BlockMasks m;
+
+				classify_blocks(p, 1, &m);
+
+				uint64_t quote = m.quote & ~find_escaped(m.backslash, open_escape);
+				uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+				uint64_t op = m.op & ~in_string;
+
+				prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+				while (op != 0) {
+					const char* q = p + trailing_zeros(op);
+
+					op &= op - 1;
+
+					if (*q == '{' || *q == '[') {
+						++depth;
+					}
+					else if ((*q == '}' || *q == ']') && --depth == 0) {
+						reader.consume(q - w.data() + 1);
+
+						return;
+					}
+				}
+			}
+
+			if (prev_in_string != 0) {
+				//A string goes on past the blocks
+				reader.consume(p - w.data());
+				skip_string_tail(open_escape != 0);
+
+				if (error_code != ERROR_NONE) {
+					return;
+				}
+
+				continue;
+			}
+
+			//The rest of the window, up to the next string
+			for (; p != end; ++p) {
+				//One table lookup per byte until something that matters
+				if (!(CHAR_CLASS[static_cast<unsigned char>(*p)] & CHAR_NESTING)) {
+					continue;
+				}
+
+				ch = *p;
+
+				if (ch == '"') {
+					break;
+				}
+				else if (ch == '{' || ch == '[') {
+					++depth;
+				}
+				else if (--depth == 0) {
+					reader.consume(p - w.data() + 1);
+
+					return;
+				}
+			}
+
+			reader.consume(p - w.data());
+
+			if (p == end && !w.empty()) {
+				continue;
+			}
+
+			//At a string, or the reader has no window
+			ch = pop();
+
+			if (ch == 0) {
+				save_error(ERROR_SYNTAX, "Premature end of document while skipping a value.");
+
+				return;
+			}
+			else if (ch == '"') {
+				putback();
+				skip_string();
+
+				if (error_code != ERROR_NONE) {
+					return;
+				}
+			}
+			else if (ch == '{' || ch == '[') {
+				++depth;
+			}
+			else if ((ch == '}' || ch == ']') && --depth == 0) {
+				return;
+			}
+		}
+	}
+
+	//Moves past a quoted string without decoding it.
+	template <typename ReaderT>
+	void BasicParser<ReaderT>::skip_string() {
+		pop();
+		skip_string_tail(false);
+	}
+
+	//Moves past the rest of a string whose opening quote has been read.
+	//With escaped the next character follows a backslash.
+	template <typename ReaderT>
+	void BasicParser<ReaderT>::skip_string_tail(bool escaped) {
+		if (escaped && pop() == 0) {
+			save_error(ERROR_SYNTAX, "Premature end of document while parsing string.");
+
+			return;
+		}
+
+		while (true) {
+			std::string_view w = reader.window();
+
+			if (!w.empty()) {
+				const char* end = w.data() + w.size();
+				const char* stop = find_string_special(w.data(), end);
+
+				reader.consume(stop - w.data());
+
+				if (stop == end) {
+					continue;
+				}
+			}
+
+			char ch = pop();
+
+			if (ch == '"') {
+				return;
+			}
+			else if (ch == 0) {
+				save_error(ERROR_SYNTAX, "Premature end of document while parsing string.");
+
+				return;
+			}
+			else if (static_cast<unsigned char>(ch) < 0x20) {
+				save_error(ERROR_SYNTAX, "Unescaped control character in string.");
+
+				return;
+			}
+			else if (ch == '\\' && pop() == 0) {
+				save_error(ERROR_SYNTAX, "Premature end of document while parsing string.");
+
+				return;
+			}
+		}
+	}
+
+	template <typename ReaderT>
+	char BasicParser<ReaderT>::peek() {
+		return reader.peek();
+	}
+	template <typename ReaderT>
+	char BasicParser<ReaderT>::pop() {
+		return reader.pop();
+	}
+
+	template <typename ReaderT>
+	void BasicParser<ReaderT>::putback() {
+		reader.putback();
+	}
+
+	template <typename ReaderT>
+	void BasicParser<ReaderT>::eat_space() {
+		while (true) {
+			std::string_view w = reader.window();
+
+			if (w.empty()) {
+				break;
+			}
+
+			//Most of the time there is no space at all or just one.
+			//Only call the vectorized skip when there is a run.
+			if (!(CHAR_CLASS[static_cast<unsigned char>(w[0])] & CHAR_SPACE)) {
+				return;
+			}
+
+			const char* end = w.data() + w.size();
+			const char* stop = skip_space(w.data() + 1, end);
+
+			reader.consume(stop - w.data());
+
+			if (stop != end) {
+				return;
+			}
+		}
+
+		//Character at a time fallback
+		char ch = pop();
+
+		if (ch == 0) return;
+
+		while (CHAR_CLASS[static_cast<unsigned char>(ch)] & CHAR_SPACE) {
+			ch = pop();
+
+			if (ch == 0) return;
+		}
+
+		putback();
+	}
+
+	template <typename ReaderT>
+	void BasicParser<ReaderT>::save_error(ErrorCode code, const char* msg) {
+		error_code = code;
+		error_message = msg;
+	}
+
+	template <typename ReaderT>
+	template <typename Handler>
+	void BasicParser<ReaderT>::parse(Handler& handler) {
+		eat_space();
+
+		char ch = peek();
+
+		if (ch == '{' || ch == '[') {
+			parse_value(handler);
+		}
+		else {
+			save_error(ERROR_SYNTAX, "Document does not start with '{' or '['.");
+		}
+	}
+
+	template <typename ReaderT>
+	template <typename Handler>
+	void BasicParser<ReaderT>::parse_value(Handler& handler) {
+		eat_space();
+
+		std::string_view s;
+
+		switch (VALUE_START[static_cast<unsigned char>(peek())]) {
+		case START_STRING:
+			if (read_string_view(s)) {
+				handler.string(s);
+			}
+
+			break;
+		case START_OBJECT:
+		case START_ARRAY:
+			if (depth >= options.max_depth) {
+				save_error(ERROR_DEPTH, "Document is nested too deeply.");
+
+				break;
+			}
+
+			++depth;
+
+			if (peek() == '{') {
+				parse_object(handler);
+			}
+			else {
+				parse_array(handler);
+			}
+
+			--depth;
+
+			break;
+		case START_NUMBER:
+			parse_number(handler);
+
+			break;
+		case START_BOOL: {
+			JSONObject b = parse_bool();
+
+			if (error_code == ERROR_NONE) {
+				handler.boolean(b.boolean());
+			}
+
+			break;
+		}
+		case START_NULL:
+			parse_null();
+
+			if (error_code == ERROR_NONE) {
+				handler.null();
+			}
+
+			break;
+		case START_END:
+			save_error(ERROR_SYNTAX, "Premature end of document while parsing a value.");
+
+			break;
+		default:
+			save_error(ERROR_SYNTAX, "Unexpected character.");
+		}
+	}
+
+	template <typename ReaderT>
+	template <typename Handler>
+	void BasicParser<ReaderT>::parse_object(Handler& handler) {
+		pop();
+		handler.start_object();
+		eat_space();
+
+		if (peek() == '}') {
+			pop();
+			handler.end_object();
+
+			return;
+		}
+
+		std::string_view name;
+
+		while (true) {
+			eat_space();
+
+			if (peek() != '"') {
+				save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+				return;
+			}
+
+			if (!read_string_view(name)) {
+				return;
+			}
+
+			handler.key(name);
+			eat_space();
+
+			if (pop() != ':') {
+				save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+				return;
+			}
+
+			parse_value(handler);
+
+			if (error_code != ERROR_NONE) {
+				return;
+			}
+
+			eat_space();
+
+			char ch = pop();
+
+			if (ch == '}') {
+				break;
+			}
+			else if (ch != ',') {
+				save_error(ERROR_SYNTAX, ch == 0 ? "Premature end of document while parsing an object." : "Invalid character in an object.");
+
+				return;
+			}
+		}
+
+		handler.end_object();
+	}
+
+	template <typename ReaderT>
+	template <typename Handler>
+	void BasicParser<ReaderT>::parse_array(Handler& handler) {
+		pop();
+		handler.start_array();
+		eat_space();
+
+		if (peek() == ']') {
+			pop();
+			handler.end_array();
+
+			return;
+		}
+
+		while (true) {
+			parse_value(handler);
+
+			if (error_code != ERROR_NONE) {
+				return;
+			}
+
+			eat_space();
+
+			char ch = pop();
+
+			if (ch == ']') {
+				break;
+			}
+			else if (ch != ',') {
+				save_error(ERROR_SYNTAX, ch == 0 ? "Premature end of documnent while parsing an array." : "Invalid character in array.");
+
+				return;
+			}
+		}
+
+		handler.end_array();
+	}
+
+	template <typename ReaderT>
+	template <typename Handler>
+	void BasicParser<ReaderT>::parse_number(Handler& handler) {
+		std::string_view token;
+
+		read_number_token(token);
+
+		if (error_code != ERROR_NONE) {
+			return;
+		}
+
+		Number n = scan_number(token.data(), token.data() + token.size());
+
+		switch (n.type) {
+		case NUMBER_INT64:
+			handler.integer(n.i);
+			break;
+		case NUMBER_UINT64:
+			handler.unsigned_integer(n.u);
+			break;
+		case NUMBER_DOUBLE:
+			handler.number(n.d);
+			break;
+		case NUMBER_OUT_OF_RANGE:
+			save_error(ERROR_SYNTAX, "Number out of range.");
+			break;
+		default:
+			save_error(ERROR_SYNTAX, "Invalid number.");
+		}
+	}
+
+	/*
+	 Reads a quoted string. A string without escapes that is inside the
+	 reader's window is returned as a view of the window, otherwise it is
+	 decoded into string_token. Either way s is only valid until the next
+	 read. Returns false on error.
+	 */
+	template <typename ReaderT>
+	bool BasicParser<ReaderT>::read_string_view(std::string_view& s) {
+		eat_space();
+
+		std::string_view w = reader.window();
+
+		if (!w.empty() && w[0] == '"') {
+			const char* end = w.data() + w.size();
+			const char* stop = find_string_special(w.data() + 1, end);
+
+			if (stop != end && *stop == '"') {
+				s = std::string_view(w.data() + 1, stop - w.data() - 1);
+				reader.consume(stop - w.data() + 1);
+
+				return true;
+			}
+		}
+
+		read_quoted_string(string_token);
+		s = string_token;
+
+		return error_code == ERROR_NONE;
+	}
+
+	extern template class BasicParser<Reader>;
+}
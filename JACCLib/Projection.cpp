@@ -0,0 +1,145 @@
+#include "Projection.h"
+
+#include <map>
+#include <algorithm>
+#include <charconv>
+
+namespace jacc {
+	Projection::Projection() {
+		compile();
+	}
+
+	Projection::Projection(std::initializer_list<std::string_view> paths) {
+		for (std::string_view path : paths) {
+			add(path);
+		}
+
+		compile();
+	}
+
+	bool Projection::add(std::string_view path) {
+		std::vector<std::string> segments;
+
+		if (!path.empty() && path[0] != '/') {
+			return false;
+		}
+
+		for (size_t i = 0; i < path.size(); ++i) {
+			char ch = path[i];
+
+			if (ch == '/') {
+				segments.emplace_back();
+			}
+			else if (ch == '~') {
+				if (i + 1 == path.size() || (path[i + 1] != '0' && path[i + 1] != '1')) {
+					return false;
+				}
+
+				segments.back().push_back(path[++i] == '0' ? '~' : '/');
+			}
+			else {
+				segments.back().push_back(ch);
+			}
+		}
+
+		paths.push_back(std::move(segments));
+		compile();
+
+		return true;
+	}
+
+	uint32_t Projection::element(uint32_t node, size_t index) const {
+		if (nodes[node].children.empty()) {
+			return nodes[node].other;
+		}
+
+		char digits[24];
+		auto result = std::to_chars(digits, digits + sizeof(digits), index);
+
+		return member(node, std::string_view(digits, result.ptr - digits));
+	}
+
+	/*
+	 Subset construction. A node stands for the set of (path, segment)
+	 positions the paths can be at after the names seen so far, so a name
+	 matched by both a named segment and "*" follows both paths.
+	 */
+	void Projection::compile() {
+		using State = std::vector<std::pair<uint32_t, uint32_t>>;
+
+		std::map<State, uint32_t> known;
+
+		nodes.clear();
+
+		auto build = [&](auto& self, State state) -> uint32_t {
+			for (const auto& position : state) {
+				if (position.second == paths[position.first].size()) {
+					//A path ends here and keeps everything below
+					return ALL;
+				}
+			}
+
+			if (state.empty()) {
+				return NONE;
+			}
+
+			std::sort(state.begin(), state.end());
+
+			auto found = known.find(state);
+
+			if (found != known.end()) {
+				return found->second;
+			}
+
+			uint32_t node = static_cast<uint32_t>(nodes.size());
+
+			nodes.emplace_back();
+			known.emplace(state, node);
+
+			State other;
+			std::vector<std::string> names;
+
+			for (const auto& position : state) {
+				const std::string& segment = paths[position.first][position.second];
+
+				if (segment == "*") {
+					other.push_back({ position.first, position.second + 1 });
+				}
+				else if (std::find(names.begin(), names.end(), segment) == names.end()) {
+					names.push_back(segment);
+				}
+			}
+
+			for (const std::string& name : names) {
+				State next = other;
+
+				for (const auto& position : state) {
+					if (paths[position.first][position.second] == name) {
+						next.push_back({ position.first, position.second + 1 });
+					}
+				}
+
+				uint32_t child = self(self, next);
+
+				nodes[node].children.push_back({ name, child });
+			}
+
+			nodes[node].other = self(self, other);
+
+			return node;
+		};
+
+		State start;
+
+		for (uint32_t i = 0; i < paths.size(); ++i) {
+			start.push_back({ i, 0 });
+		}
+
+		//Without paths nothing is selected, but the root is still parsed
+		root_node = paths.empty() ? static_cast<uint32_t>(nodes.size()) : build(build, start);
+
+		if (paths.empty()) {
+			nodes.emplace_back();
+		}
+	}
+}
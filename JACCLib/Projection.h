@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <initializer_list>
+
+namespace jacc {
+	/*
+	 A set of paths to keep when parsing, see ParseOptions::projection.
+	 Paths are JSON Pointers like "/user/id", with "~1" for '/' and "~0"
+	 for '~' in names. A segment matches an object member by name or an
+	 array element by index, and a segment that is just "*" matches any
+	 member or element. A path keeps the whole value it ends at, and ""
+	 keeps the whole document.
+
+	 The paths are compiled into a small automaton. While parsing, each
+	 open object or array is at one of its nodes, so deciding whether to
+	 keep a member is a lookup among the names the paths use there.
+	 */
+	class Projection
+	{
+	public:
+		//The value is not selected and is skipped
+		static constexpr uint32_t NONE = 0xFFFFFFFE;
+		//The value and everything in it is selected
+		static constexpr uint32_t ALL = 0xFFFFFFFF;
+
+		struct Node {
+			//Next node by member name or array index
+			std::vector<std::pair<std::string, uint32_t>> children;
+			//Next node for other names and indexes
+			uint32_t other = NONE;
+		};
+
+		std::vector<Node> nodes;
+
+		Projection();
+		Projection(std::initializer_list<std::string_view> paths);
+
+		//Adds a path like "/user/id" or "/items/*/sku". Returns false,
+		//and changes nothing, if path is not a valid JSON Pointer.
+		bool add(std::string_view path);
+
+		//Node of the document itself
+		uint32_t root() const {
+			return root_node;
+		}
+
+		uint32_t member(uint32_t node, std::string_view name) const {
+			const Node& n = nodes[node];
+
+			for (const auto& child : n.children) {
+				if (child.first == name) {
+					return child.second;
+				}
+			}
+
+			return n.other;
+		}
+
+		uint32_t element(uint32_t node, size_t index) const;
+
+	private:
+		//Paths split into unescaped segments
+		std::vector<std::vector<std::string>> paths;
+		uint32_t root_node = NONE;
+
+		void compile();
+	};
+}
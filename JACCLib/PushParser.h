@@ -0,0 +1,385 @@
+#pragma once
+
+#include "StringReader.h"
+#include <vector>
+
+namespace jacc {
+	enum PushStatus : char {
+		//The document is not complete yet, feed() more
+		PUSH_MORE,
+		PUSH_DONE,
+		PUSH_ERROR
+	};
+
+	/*
+	 Incremental parser for input that arrives in chunks, like an HTTP body
+	 read from a socket. Each feed() takes whatever bytes are available,
+	 reports what they complete to handler as events (see SaxHandler) and
+	 keeps its place. Only a string, number or literal that is cut off at
+	 the end of a chunk is buffered, so memory stays bounded by the longest
+	 value and the nesting depth, not by the document. Call finish() when
+	 the input ends. Of ParseOptions only max_depth applies.
+	 */
+	template <typename Handler>
+	class PushParser
+	{
+	public:
+		enum State : char {
+			STATE_ROOT,
+			STATE_OBJECT_START,
+			STATE_ARRAY_START,
+			STATE_KEY,
+			STATE_COLON,
+			STATE_VALUE,
+			STATE_AFTER_VALUE,
+			STATE_STRING,
+			STATE_SCALAR,
+			STATE_DONE
+		};
+
+		Handler& handler;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+		State state = STATE_ROOT;
+		//Open containers, '{' or '['
+		std::vector<char> stack;
+		//Limit on the size of stack, see ParseOptions::max_depth
+		size_t max_depth = ParseOptions().max_depth;
+		//A string, with its opening quote, or a scalar cut off by the end
+		//of a chunk
+		std::string token;
+		bool token_is_key = false;
+		bool token_has_escape = false;
+		//The last byte of the string so far is an escaping backslash
+		bool escaped = false;
+		//Decodes strings with escapes
+		StringReader token_reader;
+		BasicParser<StringReader> token_parser;
+
+		PushParser(Handler& h) : handler(h), token_parser(token_reader) {
+		}
+
+		PushParser(Handler& h, const ParseOptions& options) : handler(h), max_depth(options.max_depth), token_parser(token_reader) {
+		}
+
+		PushStatus feed(std::string_view chunk) {
+			const char* p = chunk.data();
+			const char* end = p + chunk.size();
+
+			while (p != end && error_code == ERROR_NONE) {
+				if (state == STATE_STRING) {
+					p = continue_string(p, end);
+
+					continue;
+				}
+				if (state == STATE_SCALAR) {
+					p = continue_scalar(p, end);
+
+					continue;
+				}
+
+				p = skip_space(p, end);
+
+				if (p != end) {
+					p = next_structural(p, end);
+				}
+			}
+
+			return status();
+		}
+
+		PushStatus finish() {
+			if (error_code == ERROR_NONE && state != STATE_DONE) {
+				save_error(ERROR_SYNTAX, "Premature end of document.");
+			}
+
+			return status();
+		}
+
+		PushStatus status() {
+			if (error_code != ERROR_NONE) {
+				return PUSH_ERROR;
+			}
+
+			return state == STATE_DONE ? PUSH_DONE : PUSH_MORE;
+		}
+
+		void save_error(ErrorCode code, const char* msg) {
+			error_code = code;
+			error_message = msg;
+		}
+
+	private:
+		//Handles the character at p outside of strings and scalars
+		const char* next_structural(const char* p, const char* end) {
+			char ch = *p;
+
+			switch (state) {
+			case STATE_ROOT:
+				if (ch != '{' && ch != '[') {
+					save_error(ERROR_SYNTAX, "Document does not start with '{' or '['.");
+
+					return end;
+				}
+
+				return begin_value(p);
+			case STATE_OBJECT_START:
+				if (ch == '}') {
+					return close(p);
+				}
+				//A key must follow
+				[[fallthrough]];
+			case STATE_KEY:
+				if (ch != '"') {
+					save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+					return end;
+				}
+
+				begin_string(true);
+
+				return p + 1;
+			case STATE_COLON:
+				if (ch != ':') {
+					save_error(ERROR_SYNTAX, "Invalid character in an object.");
+
+					return end;
+				}
+
+				state = STATE_VALUE;
+
+				return p + 1;
+			case STATE_ARRAY_START:
+				if (ch == ']') {
+					return close(p);
+				}
+
+				return begin_value(p);
+			case STATE_VALUE:
+				return begin_value(p);
+			case STATE_AFTER_VALUE:
+				if (ch == ',') {
+					state = stack.back() == '{' ? STATE_KEY : STATE_VALUE;
+
+					return p + 1;
+				}
+				if ((ch == '}' && stack.back() == '{') || (ch == ']' && stack.back() == '[')) {
+					return close(p);
+				}
+
+				save_error(ERROR_SYNTAX, stack.back() == '{' ? "Invalid character in an object." : "Invalid character in array.");
+
+				return end;
+			default:
+				save_error(ERROR_SYNTAX, "Unexpected data after the document.");
+
+				return end;
+			}
+		}
+
+		const char* begin_value(const char* p) {
+			switch (VALUE_START[static_cast<unsigned char>(*p)]) {
+			case START_OBJECT:
+				if (!open('{')) {
+					return p + 1;
+				}
+
+				state = STATE_OBJECT_START;
+				handler.start_object();
+
+				return p + 1;
+			case START_ARRAY:
+				if (!open('[')) {
+					return p + 1;
+				}
+
+				state = STATE_ARRAY_START;
+				handler.start_array();
+
+				return p + 1;
+			case START_STRING:
+				begin_string(false);
+
+				return p + 1;
+			case START_NUMBER:
+			case START_BOOL:
+			case START_NULL:
+				token.clear();
+				state = STATE_SCALAR;
+
+				return p;
+			default:
+				save_error(ERROR_SYNTAX, "Unexpected character.");
+
+				return p + 1;
+			}
+		}
+
+		bool open(char ch) {
+			if (stack.size() >= max_depth) {
+				save_error(ERROR_DEPTH, "Document is nested too deeply.");
+
+				return false;
+			}
+
+			stack.push_back(ch);
+
+			return true;
+		}
+
+		const char* close(const char* p) {
+			if (stack.back() == '{') {
+				handler.end_object();
+			}
+			else {
+				handler.end_array();
+			}
+
+			stack.pop_back();
+			end_value();
+
+			return p + 1;
+		}
+
+		void end_value() {
+			state = stack.empty() ? STATE_DONE : STATE_AFTER_VALUE;
+		}
+
+		void begin_string(bool is_key) {
+			token.assign(1, '"');
+			token_is_key = is_key;
+			token_has_escape = false;
+			escaped = false;
+			state = STATE_STRING;
+		}
+
+		const char* continue_string(const char* p, const char* end) {
+			while (p != end) {
+				if (escaped) {
+					token.push_back(*p++);
+					escaped = false;
+
+					continue;
+				}
+
+				const char* stop = find_string_special(p, end);
+
+				if (stop == end) {
+					token.append(p, end);
+
+					return end;
+				}
+
+				if (*stop == '"') {
+					if (token.size() == 1) {
+						//The whole string is in this chunk without escapes
+						finish_string(std::string_view(p, stop - p));
+					}
+					else {
+						token.append(p, stop);
+						finish_string(std::string_view(token).substr(1));
+					}
+
+					return stop + 1;
+				}
+
+				if (*stop == '\\') {
+					token.append(p, stop + 1);
+					token_has_escape = true;
+					escaped = true;
+					p = stop + 1;
+
+					continue;
+				}
+
+				save_error(ERROR_SYNTAX, "Unescaped control character in string.");
+
+				return end;
+			}
+
+			return end;
+		}
+
+		//Takes the string between the quotes, before escapes are decoded
+		void finish_string(std::string_view s) {
+			if (token_has_escape) {
+				token.push_back('"');
+				token_reader.data = token;
+				token_reader.location = 0;
+				token_parser.read_quoted_string(token_parser.string_token);
+
+				if (token_parser.error_code != ERROR_NONE) {
+					save_error(token_parser.error_code, token_parser.error_message);
+
+					return;
+				}
+
+				s = token_parser.string_token;
+			}
+
+			if (token_is_key) {
+				handler.key(s);
+				state = STATE_COLON;
+			}
+			else {
+				handler.string(s);
+				end_value();
+			}
+		}
+
+		const char* continue_scalar(const char* p, const char* end) {
+			const char* stop = find_token_end(p, end);
+
+			if (stop == end) {
+				token.append(p, end);
+
+				return end;
+			}
+
+			if (token.empty()) {
+				finish_scalar(std::string_view(p, stop - p));
+			}
+			else {
+				token.append(p, stop);
+				finish_scalar(token);
+			}
+
+			//The character that ended the scalar is handled next
+			return stop;
+		}
+
+		void finish_scalar(std::string_view s) {
+			if (s == "true" || s == "false") {
+				handler.boolean(s[0] == 't');
+			}
+			else if (s == "null") {
+				handler.null();
+			}
+			else {
+				Number n = scan_number(s.data(), s.data() + s.size());
+
+				switch (n.type) {
+				case NUMBER_INT64:
+					handler.integer(n.i);
+					break;
+				case NUMBER_UINT64:
+					handler.unsigned_integer(n.u);
+					break;
+				case NUMBER_DOUBLE:
+					handler.number(n.d);
+					break;
+				case NUMBER_OUT_OF_RANGE:
+					save_error(ERROR_SYNTAX, "Number out of range.");
+
+					return;
+				default:
+					save_error(ERROR_SYNTAX, VALUE_START[static_cast<unsigned char>(s[0])] == START_NUMBER ? "Invalid number." : "Invalid literal.");
+
+					return;
+				}
+			}
+
+			end_value();
+		}
+	};
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "StringReader.h"
+#include <vector>
+#include <cstring>
+
+namespace jacc {
+	//A line of the input that could not be parsed, see RecordStream
+	struct RecordError {
+		//Position of the first byte of the line in the input
+		size_t offset;
+		//Line number, counting from 1
+		size_t line;
+		ErrorCode error_code;
+		const char* error_message;
+	};
+
+	/*
+	 Reads newline delimited JSON (NDJSON, JSON Lines): one value per line,
+	 any kind of value. next() parses one record at a time with the same
+	 parser, so its scratch buffers, frame stack and options.resource are
+	 reused from record to record. Blank lines are skipped.
+
+	 Lines are found with a bulk scan of the reader's window() and parsed
+	 in place when a whole line is in the window, otherwise the line is
+	 first copied into a reused buffer. With zero_copy or lazy_numbers, a
+	 record's strings and numbers may point into the line, so they stay
+	 valid only until the next call to next() unless the reader is
+	 persistent, like MemoryMappedReader.
+
+	 A line that does not hold exactly one valid value stops the stream
+	 with error_code set, or with skip_invalid is recorded in errors and
+	 passed over.
+	 */
+	template <typename ReaderT>
+	class RecordStream
+	{
+	public:
+		ReaderT& reader;
+		//Reads the current line
+		StringReader line_reader;
+		BasicParser<StringReader> parser;
+		bool skip_invalid = false;
+		//Lines passed over with skip_invalid
+		std::vector<RecordError> errors;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+		//Where the current record starts in the input, and its line number
+		size_t offset = 0;
+		size_t line = 0;
+
+		RecordStream(ReaderT& r) : reader(r), parser(line_reader) {
+		}
+
+		RecordStream(ReaderT& r, const ParseOptions& o) : reader(r), parser(line_reader, o) {
+		}
+
+		RecordStream(const RecordStream&) = delete;
+		RecordStream& operator=(const RecordStream&) = delete;
+
+		//Parses the next record into record. Returns false at the end of
+		//the input or when a line fails without skip_invalid.
+		bool next(JSONObject& record) {
+			if (error_code != ERROR_NONE) {
+				return false;
+			}
+
+			while (next_line()) {
+				parser.error_code = ERROR_NONE;
+				parser.error_message = nullptr;
+				parser.eat_space();
+
+				if (line_reader.location == line_reader.data.size()) {
+					continue;
+				}
+
+				record = parser.parse_value();
+
+				if (parser.error_code == ERROR_NONE) {
+					parser.eat_space();
+
+					if (line_reader.location == line_reader.data.size()) {
+						return true;
+					}
+
+					parser.save_error(ERROR_SYNTAX, "Unexpected data after the record.");
+				}
+
+				if (!skip_invalid) {
+					error_code = parser.error_code;
+					error_message = parser.error_message;
+
+					return false;
+				}
+
+				errors.push_back({ offset, line, parser.error_code, parser.error_message });
+			}
+
+			return false;
+		}
+
+		//Starts counting offsets and lines over, for when reader has been
+		//pointed at new input. The parser and its buffers are kept.
+		void reset() {
+			errors.clear();
+			error_code = ERROR_NONE;
+			error_message = nullptr;
+			offset = 0;
+			line = 0;
+			position = 0;
+		}
+
+	private:
+		//Bytes taken from reader so far
+		size_t position = 0;
+		//Holds a line that is not in one window
+		std::string line_buffer;
+
+		void take(size_t n) {
+			reader.consume(n);
+			position += n;
+		}
+
+		//Points line_reader at the next line, without its '\n'. Returns
+		//false when the input is exhausted.
+		bool next_line() {
+			bool copied = false;
+
+			line_buffer.clear();
+			offset = position;
+
+			for (;;) {
+				std::string_view w = reader.window();
+
+				if (w.empty()) {
+					//End of input, or a reader without bulk access
+					char ch = reader.pop();
+
+					if (ch == '\0') {
+						if (!copied) {
+							return false;
+						}
+
+						break;
+					}
+
+					++position;
+					copied = true;
+
+					if (ch == '\n') {
+						break;
+					}
+
+					line_buffer.push_back(ch);
+
+					continue;
+				}
+
+				const char* end = static_cast<const char*>(std::memchr(w.data(), '\n', w.size()));
+
+				if (end != nullptr && !copied) {
+					//The whole line is in the window
+					line_reader.data = std::string_view(w.data(), end - w.data());
+					line_reader.location = 0;
+					++line;
+					take(end - w.data() + 1);
+
+					return true;
+				}
+
+				if (end == nullptr && !copied && reader.persistent()) {
+					take(w.size());
+
+					if (reader.window().empty()) {
+						//The last line, without a '\n'. It stays in place so
+						//that values can keep pointing into it.
+						line_reader.data = w;
+						line_reader.location = 0;
+						++line;
+
+						return true;
+					}
+
+					line_buffer.append(w.data(), w.size());
+					copied = true;
+
+					continue;
+				}
+
+				size_t n = end != nullptr ? end - w.data() : w.size();
+
+				line_buffer.append(w.data(), n);
+				copied = true;
+				take(end != nullptr ? n + 1 : n);
+
+				if (end != nullptr) {
+					break;
+				}
+			}
+
+			line_reader.data = line_buffer;
+			line_reader.location = 0;
+			++line;
+
+			return true;
+		}
+	};
+}
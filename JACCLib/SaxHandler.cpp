@@ -0,0 +1,97 @@
+#include "SaxHandler.h"
+
+#include <cstring>
+
+namespace jacc {
+	DOMBuilder::DOMBuilder(std::pmr::memory_resource* r) : resource(r != nullptr ? r : std::pmr::get_default_resource()) {
+	}
+
+	//Adds a finished value to the innermost open container, or makes
+	//it the root when there is none.
+	void DOMBuilder::add(JSONObject&& value) {
+		if (stack.empty()) {
+			root = std::move(value);
+
+			return;
+		}
+
+		JSONObject& parent = stack.back();
+
+		if (parent.isObject()) {
+			parent.object().emplace(keys.back(), std::move(value));
+			keys.pop_back();
+		}
+		else {
+			parent.array().push_back(std::move(value));
+		}
+	}
+
+	void DOMBuilder::start_object() {
+		JSONObject::Object map(resource);
+
+		stack.emplace_back(map);
+	}
+
+	void DOMBuilder::key(std::string_view name) {
+		keys.emplace_back(name);
+	}
+
+	void DOMBuilder::end_object() {
+		JSONObject value = std::move(stack.back());
+
+		stack.pop_back();
+		add(std::move(value));
+	}
+
+	void DOMBuilder::start_array() {
+		JSONObject::Array list(resource);
+
+		stack.emplace_back(list);
+	}
+
+	void DOMBuilder::end_array() {
+		JSONObject value = std::move(stack.back());
+
+		stack.pop_back();
+		add(std::move(value));
+	}
+
+	void DOMBuilder::string(std::string_view s) {
+		if (resource == std::pmr::get_default_resource()) {
+			add(JSONObject(std::string(s)));
+
+			return;
+		}
+
+		if (s.empty()) {
+			add(JSONObject(std::string_view()));
+
+			return;
+		}
+
+		char* copy = static_cast<char*>(resource->allocate(s.size(), 1));
+
+		std::memcpy(copy, s.data(), s.size());
+		add(JSONObject(std::string_view(copy, s.size())));
+	}
+
+	void DOMBuilder::number(double n) {
+		add(JSONObject(n));
+	}
+
+	void DOMBuilder::integer(int64_t n) {
+		add(JSONObject(n));
+	}
+
+	void DOMBuilder::unsigned_integer(uint64_t n) {
+		add(JSONObject(n));
+	}
+
+	void DOMBuilder::boolean(bool b) {
+		add(JSONObject(b));
+	}
+
+	void DOMBuilder::null() {
+		add(JSONObject(JSON_NULL()));
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Parser.h"
+#include <vector>
+
+namespace jacc {
+	/*
+	 Base for handlers passed to BasicParser::parse(Handler&). Derive with
+	 the handler itself as Derived and define the callbacks you need, the
+	 rest do nothing. Integers go to integer() or unsigned_integer(),
+	 which by default forward to number(). Views passed to key() and
+	 string() are only valid during the call.
+	 */
+	template <typename Derived>
+	struct SaxHandler {
+		void start_object() {}
+		void key(std::string_view) {}
+		void end_object() {}
+		void start_array() {}
+		void end_array() {}
+		void string(std::string_view) {}
+		void number(double) {}
+
+		void integer(int64_t n) {
+			static_cast<Derived*>(this)->number(static_cast<double>(n));
+		}
+
+		void unsigned_integer(uint64_t n) {
+			static_cast<Derived*>(this)->number(static_cast<double>(n));
+		}
+
+		void boolean(bool) {}
+		void null() {}
+	};
+
+	/*
+	 Builds a JSONObject tree from parser events, keeping the containers
+	 that are still open on a stack. BasicParser::parse() builds the same
+	 tree directly, and also supports zero copy strings, lazy numbers and
+	 packed arrays. With a resource, strings are copied into it and stored
+	 as std::string_view, as with ParseOptions::resource.
+	 */
+	struct DOMBuilder : SaxHandler<DOMBuilder> {
+		std::pmr::memory_resource* resource;
+		JSONObject root;
+		std::vector<JSONObject> stack;
+		//Name of the member being read, one per open object
+		std::vector<std::string> keys;
+
+		DOMBuilder(std::pmr::memory_resource* r = nullptr);
+
+		void add(JSONObject&& value);
+
+		void start_object();
+		void key(std::string_view name);
+		void end_object();
+		void start_array();
+		void end_array();
+		void string(std::string_view s);
+		void number(double n);
+		void integer(int64_t n);
+		void unsigned_integer(uint64_t n);
+		void boolean(bool b);
+		void null();
+	};
+}
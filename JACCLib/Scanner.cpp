@@ -0,0 +1,546 @@
+#include "Scanner.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define JACC_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define JACC_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define JACC_TARGET(isa)
+#else
+#define JACC_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace jacc {
+	static inline bool is_json_space(char ch) {
+		return CHAR_CLASS[static_cast<unsigned char>(ch)] & CHAR_SPACE;
+	}
+
+	static inline bool is_token_end(char ch) {
+		return CHAR_CLASS[static_cast<unsigned char>(ch)] & CHAR_TOKEN_END;
+	}
+
+	static inline bool is_string_special(char ch) {
+		return CHAR_CLASS[static_cast<unsigned char>(ch)] & CHAR_STRING_SPECIAL;
+	}
+
+	static const char* skip_space_scalar(const char* p, const char* end) {
+		while (p < end && is_json_space(*p)) {
+			++p;
+		}
+
+		return p;
+	}
+
+	static const char* find_token_end_scalar(const char* p, const char* end) {
+		while (p < end && !is_token_end(*p)) {
+			++p;
+		}
+
+		return p;
+	}
+
+	static const char* find_string_special_scalar(const char* p, const char* end) {
+		while (p < end && !is_string_special(*p)) {
+			++p;
+		}
+
+		return p;
+	}
+
+	static void classify_blocks_scalar(const char* data, size_t block_count, BlockMasks* masks) {
+		for (size_t b = 0; b < block_count; ++b, data += 64) {
+			BlockMasks m = {};
+
+			for (unsigned i = 0; i < 64; ++i) {
+				uint64_t bit = uint64_t(1) << i;
+
+				switch (data[i]) {
+				case '\\':
+					m.backslash |= bit;
+					break;
+				case '"':
+					m.quote |= bit;
+					break;
+				case '{': case '}': case '[': case ']': case ':': case ',':
+					m.op |= bit;
+					break;
+				case ' ': case '\t': case '\n': case '\r':
+					m.space |= bit;
+					break;
+				}
+			}
+
+			masks[b] = m;
+		}
+	}
+
+#ifdef JACC_X86
+	/*
+	 SSE4.2 versions. PCMPESTRM compares each input byte against a small set
+	 of characters (or ranges) and gives back a bit mask. Explicit lengths are
+	 used so that NUL bytes in the input are not taken as a terminator.
+	 */
+	constexpr int SPACE_MODE = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_NEGATIVE_POLARITY | _SIDD_BIT_MASK;
+	constexpr int TOKEN_END_MODE = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+	constexpr int STRING_SPECIAL_MODE = _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_BIT_MASK;
+
+	/*
+	 Runs a PCMPESTRM search over [p, end). When fewer than 16 bytes are left
+	 the last 16 bytes of the buffer are loaded again and the bits for the
+	 bytes already looked at are shifted out. That needs the buffer to be at
+	 least 16 bytes long, shorter buffers are left to the scalar code.
+	 */
+	template <int MODE>
+	JACC_TARGET("sse4.2")
+	static inline const char* pcmpestrm_search(const char* begin, const char* end, __m128i set, int set_length) {
+		const char* p = begin;
+
+		for (; end - p >= 16; p += 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			uint32_t mask = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_cmpestrm(set, set_length, v, 16, MODE)));
+
+			if (mask != 0) {
+				return p + trailing_zeros(mask);
+			}
+		}
+
+		if (p < end && end - begin >= 16) {
+			const char* last = end - 16;
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(last));
+			uint32_t mask = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_cmpestrm(set, set_length, v, 16, MODE)));
+
+			mask = (mask & 0xFFFF) >> (p - last);
+
+			return mask != 0 ? p + trailing_zeros(mask) : end;
+		}
+
+		return p;
+	}
+
+	JACC_TARGET("sse4.2")
+	static const char* skip_space_sse42(const char* p, const char* end) {
+		const __m128i set = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+		return skip_space_scalar(pcmpestrm_search<SPACE_MODE>(p, end, set, 4), end);
+	}
+
+	JACC_TARGET("sse4.2")
+	static const char* find_token_end_sse42(const char* p, const char* end) {
+		const __m128i set = _mm_setr_epi8(',', '}', ']', ' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+		return find_token_end_scalar(pcmpestrm_search<TOKEN_END_MODE>(p, end, set, 7), end);
+	}
+
+	JACC_TARGET("sse4.2")
+	static const char* find_string_special_sse42(const char* p, const char* end) {
+		//Ranges: 0x00-0x1F, '"'-'"', '\\'-'\\'
+		const __m128i set = _mm_setr_epi8(0x00, 0x1F, '"', '"', '\\', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+		return find_string_special_scalar(pcmpestrm_search<STRING_SPECIAL_MODE>(p, end, set, 6), end);
+	}
+
+	JACC_TARGET("sse4.2")
+	static void classify_blocks_sse42(const char* data, size_t block_count, BlockMasks* masks) {
+		for (size_t b = 0; b < block_count; ++b, data += 64) {
+			BlockMasks m = {};
+
+			for (unsigned i = 0; i < 64; i += 16) {
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				__m128i op = _mm_or_si128(
+					_mm_or_si128(
+						_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')), _mm_cmpeq_epi8(v, _mm_set1_epi8('}'))),
+						_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('[')), _mm_cmpeq_epi8(v, _mm_set1_epi8(']')))),
+					_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+				__m128i space = _mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+					_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+
+				m.backslash |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))))) << i;
+				m.quote |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))))) << i;
+				m.op |= uint64_t(uint32_t(_mm_movemask_epi8(op))) << i;
+				m.space |= uint64_t(uint32_t(_mm_movemask_epi8(space))) << i;
+			}
+
+			masks[b] = m;
+		}
+	}
+
+	/*
+	 AVX2 versions. Each compares 32 bytes against every interesting
+	 character and combines the results into a bit mask. The tail is handled
+	 the same way as the SSE4.2 versions by reloading the last 32 bytes.
+	 */
+	JACC_TARGET("avx2")
+	static inline __m256i space_bytes_avx2(__m256i v) {
+		return _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+	}
+
+	JACC_TARGET("avx2")
+	static inline uint32_t non_space_mask_avx2(const char* p) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+
+		return ~static_cast<uint32_t>(_mm256_movemask_epi8(space_bytes_avx2(v)));
+	}
+
+	JACC_TARGET("avx2")
+	static inline uint32_t token_end_mask_avx2(const char* p) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		__m256i m = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('}'))),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(']')), space_bytes_avx2(v)));
+
+		return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+	}
+
+	JACC_TARGET("avx2")
+	static inline uint32_t string_special_mask_avx2(const char* p) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		//Unsigned c < 0x20 is the same as max(c, 0x1F) == 0x1F
+		const __m256i control = _mm256_set1_epi8(0x1F);
+		__m256i m = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+			_mm256_cmpeq_epi8(_mm256_max_epu8(v, control), control));
+
+		return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+	}
+
+	template <uint32_t (*MASK)(const char*)>
+	JACC_TARGET("avx2")
+	static inline const char* avx2_search(const char* begin, const char* end) {
+		const char* p = begin;
+
+		for (; end - p >= 32; p += 32) {
+			uint32_t mask = MASK(p);
+
+			if (mask != 0) {
+				return p + trailing_zeros(mask);
+			}
+		}
+
+		if (p < end && end - begin >= 32) {
+			const char* last = end - 32;
+			uint32_t mask = MASK(last) >> (p - last);
+
+			return mask != 0 ? p + trailing_zeros(mask) : end;
+		}
+
+		return p;
+	}
+
+	JACC_TARGET("avx2")
+	static const char* skip_space_avx2(const char* p, const char* end) {
+		return skip_space_scalar(avx2_search<non_space_mask_avx2>(p, end), end);
+	}
+
+	JACC_TARGET("avx2")
+	static const char* find_token_end_avx2(const char* p, const char* end) {
+		return find_token_end_scalar(avx2_search<token_end_mask_avx2>(p, end), end);
+	}
+
+	JACC_TARGET("avx2")
+	static const char* find_string_special_avx2(const char* p, const char* end) {
+		return find_string_special_scalar(avx2_search<string_special_mask_avx2>(p, end), end);
+	}
+
+	JACC_TARGET("avx2")
+	static void classify_blocks_avx2(const char* data, size_t block_count, BlockMasks* masks) {
+		for (size_t b = 0; b < block_count; ++b, data += 64) {
+			BlockMasks m = {};
+
+			for (unsigned i = 0; i < 64; i += 32) {
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				__m256i op = _mm256_or_si256(
+					_mm256_or_si256(
+						_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('}'))),
+						_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(']')))),
+					_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+
+				m.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))))) << i;
+				m.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))))) << i;
+				m.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << i;
+				m.space |= uint64_t(uint32_t(_mm256_movemask_epi8(space_bytes_avx2(v)))) << i;
+			}
+
+			masks[b] = m;
+		}
+	}
+
+	/*
+	 AVX-512 versions. Comparisons produce a 64 bit mask directly, and the
+	 tail uses a masked load, so no scalar code is needed.
+	 */
+#define JACC_AVX512 "avx512f,avx512bw"
+
+	JACC_TARGET(JACC_AVX512)
+	static inline __mmask64 space_mask_avx512(__m512i v) {
+		return _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' ')) |
+			_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\t')) |
+			_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n')) |
+			_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r'));
+	}
+
+	JACC_TARGET(JACC_AVX512)
+	static inline uint64_t non_space_mask_avx512(__m512i v) {
+		return ~space_mask_avx512(v);
+	}
+
+	JACC_TARGET(JACC_AVX512)
+	static inline uint64_t token_end_mask_avx512(__m512i v) {
+		return _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(',')) |
+			_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('}')) |
+			_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(']')) |
+			space_mask_avx512(v);
+	}
+
+	JACC_TARGET(JACC_AVX512)
+	static inline uint64_t string_special_mask_avx512(__m512i v) {
+		return _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"')) |
+			_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\')) |
+			_mm512_cmplt_epu8_mask(v, _mm512_set1_epi8(0x20));
+	}
+
+	template <uint64_t (*MASK)(__m512i)>
+	JACC_TARGET(JACC_AVX512)
+	static inline const char* avx512_search(const char* p, const char* end) {
+		for (; end - p >= 64; p += 64) {
+			uint64_t mask = MASK(_mm512_loadu_si512(p));
+
+			if (mask != 0) {
+				return p + trailing_zeros(mask);
+			}
+		}
+
+		if (p < end) {
+			uint64_t valid = (uint64_t(1) << (end - p)) - 1;
+			uint64_t mask = MASK(_mm512_maskz_loadu_epi8(valid, p)) & valid;
+
+			return mask != 0 ? p + trailing_zeros(mask) : end;
+		}
+
+		return p;
+	}
+
+	JACC_TARGET(JACC_AVX512)
+	static const char* skip_space_avx512(const char* p, const char* end) {
+		return avx512_search<non_space_mask_avx512>(p, end);
+	}
+
+	JACC_TARGET(JACC_AVX512)
+	static const char* find_token_end_avx512(const char* p, const char* end) {
+		return avx512_search<token_end_mask_avx512>(p, end);
+	}
+
+	JACC_TARGET(JACC_AVX512)
+	static const char* find_string_special_avx512(const char* p, const char* end) {
+		return avx512_search<string_special_mask_avx512>(p, end);
+	}
+
+	JACC_TARGET(JACC_AVX512)
+	static void classify_blocks_avx512(const char* data, size_t block_count, BlockMasks* masks) {
+		for (size_t b = 0; b < block_count; ++b, data += 64) {
+			__m512i v = _mm512_loadu_si512(data);
+
+			masks[b].backslash = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+			masks[b].quote = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'));
+			masks[b].op = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('{')) |
+				_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('}')) |
+				_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('[')) |
+				_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(']')) |
+				_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(':')) |
+				_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(','));
+			masks[b].space = space_mask_avx512(v);
+		}
+	}
+#endif
+
+#ifdef JACC_NEON
+	/*
+	 NEON versions. They only detect whether a 16 byte block has a match and
+	 let the scalar code find its exact position.
+	 */
+	static inline uint8x16_t space_bytes_neon(uint8x16_t v) {
+		return vorrq_u8(
+			vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\t'))),
+			vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')), vceqq_u8(v, vdupq_n_u8('\r'))));
+	}
+
+	static const char* skip_space_neon(const char* p, const char* end) {
+		for (; end - p >= 16; p += 16) {
+			uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+
+			if (vminvq_u8(space_bytes_neon(v)) == 0) {
+				break;
+			}
+		}
+
+		return skip_space_scalar(p, end);
+	}
+
+	static const char* find_token_end_neon(const char* p, const char* end) {
+		for (; end - p >= 16; p += 16) {
+			uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+			uint8x16_t m = vorrq_u8(
+				vorrq_u8(vceqq_u8(v, vdupq_n_u8(',')), vceqq_u8(v, vdupq_n_u8('}'))),
+				vorrq_u8(vceqq_u8(v, vdupq_n_u8(']')), space_bytes_neon(v)));
+
+			if (vmaxvq_u8(m) != 0) {
+				break;
+			}
+		}
+
+		return find_token_end_scalar(p, end);
+	}
+
+	static const char* find_string_special_neon(const char* p, const char* end) {
+		for (; end - p >= 16; p += 16) {
+			uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+			uint8x16_t m = vorrq_u8(
+				vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))),
+				vcltq_u8(v, vdupq_n_u8(0x20)));
+
+			if (vmaxvq_u8(m) != 0) {
+				break;
+			}
+		}
+
+		return find_string_special_scalar(p, end);
+	}
+
+	//Packs the result of 4 byte comparisons (0xFF or 0) into a 64 bit mask.
+	static inline uint64_t to_bitmask_neon(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3) {
+		static const uint8_t bits[16] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+		const uint8x16_t bit_mask = vld1q_u8(bits);
+		uint8x16_t sum0 = vpaddq_u8(vandq_u8(m0, bit_mask), vandq_u8(m1, bit_mask));
+		uint8x16_t sum1 = vpaddq_u8(vandq_u8(m2, bit_mask), vandq_u8(m3, bit_mask));
+
+		sum0 = vpaddq_u8(sum0, sum1);
+		sum0 = vpaddq_u8(sum0, sum0);
+
+		return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+	}
+
+	static inline uint8x16_t op_bytes_neon(uint8x16_t v) {
+		return vorrq_u8(
+			vorrq_u8(
+				vorrq_u8(vceqq_u8(v, vdupq_n_u8('{')), vceqq_u8(v, vdupq_n_u8('}'))),
+				vorrq_u8(vceqq_u8(v, vdupq_n_u8('[')), vceqq_u8(v, vdupq_n_u8(']')))),
+			vorrq_u8(vceqq_u8(v, vdupq_n_u8(':')), vceqq_u8(v, vdupq_n_u8(','))));
+	}
+
+	static void classify_blocks_neon(const char* data, size_t block_count, BlockMasks* masks) {
+		const uint8x16_t backslash = vdupq_n_u8('\\');
+		const uint8x16_t quote = vdupq_n_u8('"');
+
+		for (size_t b = 0; b < block_count; ++b, data += 64) {
+			const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+			uint8x16_t v0 = vld1q_u8(p);
+			uint8x16_t v1 = vld1q_u8(p + 16);
+			uint8x16_t v2 = vld1q_u8(p + 32);
+			uint8x16_t v3 = vld1q_u8(p + 48);
+
+			masks[b].backslash = to_bitmask_neon(vceqq_u8(v0, backslash), vceqq_u8(v1, backslash), vceqq_u8(v2, backslash), vceqq_u8(v3, backslash));
+			masks[b].quote = to_bitmask_neon(vceqq_u8(v0, quote), vceqq_u8(v1, quote), vceqq_u8(v2, quote), vceqq_u8(v3, quote));
+			masks[b].op = to_bitmask_neon(op_bytes_neon(v0), op_bytes_neon(v1), op_bytes_neon(v2), op_bytes_neon(v3));
+			masks[b].space = to_bitmask_neon(space_bytes_neon(v0), space_bytes_neon(v1), space_bytes_neon(v2), space_bytes_neon(v3));
+		}
+	}
+#endif
+
+	Isa detected_isa() {
+#ifdef JACC_X86
+#ifdef _MSC_VER
+		int info[4];
+
+		__cpuid(info, 1);
+
+		bool sse42 = (info[2] & (1 << 20)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+
+		__cpuidex(info, 7, 0);
+
+		bool avx2 = avx && (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+		bool avx512 = (xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+#else
+		__builtin_cpu_init();
+
+		bool sse42 = __builtin_cpu_supports("sse4.2");
+		bool avx2 = __builtin_cpu_supports("avx2");
+		bool avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+		if (avx512) {
+			return ISA_AVX512;
+		}
+		if (avx2) {
+			return ISA_AVX2;
+		}
+		if (sse42) {
+			return ISA_SSE42;
+		}
+#endif
+#ifdef JACC_NEON
+		return ISA_NEON;
+#endif
+		return ISA_SCALAR;
+	}
+
+	static ScanFunctions functions_for(Isa isa) {
+		switch (isa) {
+#ifdef JACC_X86
+		case ISA_AVX512:
+			return { skip_space_avx512, find_token_end_avx512, find_string_special_avx512, classify_blocks_avx512 };
+		case ISA_AVX2:
+			return { skip_space_avx2, find_token_end_avx2, find_string_special_avx2, classify_blocks_avx2 };
+		case ISA_SSE42:
+			return { skip_space_sse42, find_token_end_sse42, find_string_special_sse42, classify_blocks_sse42 };
+#endif
+#ifdef JACC_NEON
+		case ISA_NEON:
+			return { skip_space_neon, find_token_end_neon, find_string_special_neon, classify_blocks_neon };
+#endif
+		default:
+			return { skip_space_scalar, find_token_end_scalar, find_string_special_scalar, classify_blocks_scalar };
+		}
+	}
+
+	static Isa current_isa = ISA_SCALAR;
+
+	ScanFunctions& scan_functions() {
+		static ScanFunctions functions = [] {
+			current_isa = detected_isa();
+
+			return functions_for(current_isa);
+		}();
+
+		return functions;
+	}
+
+	Isa active_isa() {
+		scan_functions();
+
+		return current_isa;
+	}
+
+	bool force_isa(Isa isa) {
+		Isa best = detected_isa();
+		bool supported = isa == ISA_SCALAR || isa == best ||
+			(best != ISA_NEON && isa != ISA_NEON && isa < best);
+
+		if (!supported) {
+			return false;
+		}
+
+		scan_functions() = functions_for(isa);
+		current_isa = isa;
+
+		return true;
+	}
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+ Low level scanning routines and lookup tables used by the parser.
+ */
+namespace jacc {
+	constexpr std::array<uint8_t, 256> make_hex_table() {
+		std::array<uint8_t, 256> table{};
+
+		for (size_t i = 0; i < table.size(); ++i) {
+			table[i] = 0xFF;
+		}
+		for (uint8_t i = 0; i < 10; ++i) {
+			table['0' + i] = i;
+		}
+		for (uint8_t i = 0; i < 6; ++i) {
+			table['a' + i] = 10 + i;
+			table['A' + i] = 10 + i;
+		}
+
+		return table;
+	}
+
+	//Value of a hex digit or 0xFF if the character is not one.
+	inline constexpr std::array<uint8_t, 256> HEX_DIGIT = make_hex_table();
+
+	//Bits of CHAR_CLASS
+	enum CharClass : uint8_t {
+		//JSON whitespace. Only space, tab, line feed and carriage return,
+		//independent of the C locale.
+		CHAR_SPACE = 1,
+		//Ends a number or literal: whitespace, ',', '}' or ']'
+		CHAR_TOKEN_END = 2,
+		//Needs attention inside a string: '"', '\\' or a control character
+		CHAR_STRING_SPECIAL = 4,
+		//Matters when skipping a container: '"', '{', '}', '[' or ']'
+		CHAR_NESTING = 8
+	};
+
+	constexpr std::array<uint8_t, 256> make_char_class_table() {
+		std::array<uint8_t, 256> table{};
+
+		for (char ch : {' ', '\t', '\n', '\r'}) {
+			table[static_cast<unsigned char>(ch)] |= CHAR_SPACE | CHAR_TOKEN_END;
+		}
+		for (char ch : {',', '}', ']'}) {
+			table[static_cast<unsigned char>(ch)] |= CHAR_TOKEN_END;
+		}
+		for (size_t i = 0; i < 0x20; ++i) {
+			table[i] |= CHAR_STRING_SPECIAL;
+		}
+
+		table['"'] |= CHAR_STRING_SPECIAL;
+		table['\\'] |= CHAR_STRING_SPECIAL;
+
+		for (char ch : {'"', '{', '}', '[', ']'}) {
+			table[static_cast<unsigned char>(ch)] |= CHAR_NESTING;
+		}
+
+		return table;
+	}
+
+	inline constexpr std::array<uint8_t, 256> CHAR_CLASS = make_char_class_table();
+
+	//Kind of value that starts with a given character
+	enum ValueStart : uint8_t {
+		START_INVALID,
+		START_END,
+		START_STRING,
+		START_OBJECT,
+		START_ARRAY,
+		START_NUMBER,
+		START_BOOL,
+		START_NULL
+	};
+
+	constexpr std::array<uint8_t, 256> make_value_start_table() {
+		std::array<uint8_t, 256> table{};
+
+		table['\0'] = START_END;
+		table['"'] = START_STRING;
+		table['{'] = START_OBJECT;
+		table['['] = START_ARRAY;
+		table['-'] = START_NUMBER;
+
+		for (char ch = '0'; ch <= '9'; ++ch) {
+			table[static_cast<unsigned char>(ch)] = START_NUMBER;
+		}
+
+		table['t'] = START_BOOL;
+		table['f'] = START_BOOL;
+		table['n'] = START_NULL;
+
+		return table;
+	}
+
+	inline constexpr std::array<uint8_t, 256> VALUE_START = make_value_start_table();
+
+	constexpr std::array<char, 256> make_escape_table() {
+		std::array<char, 256> table{};
+
+		table['"'] = '"';
+		table['\\'] = '\\';
+		table['/'] = '/';
+		table['b'] = '\b';
+		table['f'] = '\f';
+		table['n'] = '\n';
+		table['r'] = '\r';
+		table['t'] = '\t';
+
+		return table;
+	}
+
+	//Character produced by a two character escape like \n, or 0 if the
+	//escape is invalid. \u escapes are handled separately.
+	inline constexpr std::array<char, 256> ESCAPE_CHAR = make_escape_table();
+
+	//Instruction sets the scanning routines can be built for.
+	enum Isa : char {
+		ISA_SCALAR,
+		ISA_NEON,
+		ISA_SSE42,
+		ISA_AVX2,
+		ISA_AVX512
+	};
+
+	//Positions of interesting characters in a 64 byte block, one bit per byte.
+	struct BlockMasks {
+		uint64_t backslash;
+		uint64_t quote;
+		//One of {}[]:,
+		uint64_t op;
+		uint64_t space;
+	};
+
+	/*
+	 The scanning routines in use. They are picked on first use based on
+	 what the CPU supports. The search routines look at [begin, end) and
+	 return end if nothing is found.
+	 */
+	struct ScanFunctions {
+		//First byte that is not JSON whitespace
+		const char* (*skip_space)(const char* begin, const char* end);
+		//First ',', '}', ']' or whitespace, i.e. the end of a number or literal
+		const char* (*find_token_end)(const char* begin, const char* end);
+		//First '"', '\\' or control character (below 0x20)
+		const char* (*find_string_special)(const char* begin, const char* end);
+		//Fills one BlockMasks for each of the block_count 64 byte blocks at data
+		void (*classify_blocks)(const char* data, size_t block_count, BlockMasks* masks);
+	};
+
+	ScanFunctions& scan_functions();
+
+	//Best instruction set supported by this CPU.
+	Isa detected_isa();
+	//Instruction set currently used by the scanning routines.
+	Isa active_isa();
+	/*
+	 Switches the scanning routines to the given instruction set. Mainly for
+	 benchmarking. Returns false and changes nothing if the CPU or the build
+	 does not support it. Not thread safe, call it before parsing starts.
+	 */
+	bool force_isa(Isa isa);
+
+	inline const char* skip_space(const char* begin, const char* end) {
+		return scan_functions().skip_space(begin, end);
+	}
+
+	inline const char* find_token_end(const char* begin, const char* end) {
+		return scan_functions().find_token_end(begin, end);
+	}
+
+	inline const char* find_string_special(const char* begin, const char* end) {
+		return scan_functions().find_string_special(begin, end);
+	}
+
+	inline void classify_blocks(const char* data, size_t block_count, BlockMasks* masks) {
+		scan_functions().classify_blocks(data, block_count, masks);
+	}
+
+	inline unsigned trailing_zeros(uint64_t mask) {
+#ifdef _MSC_VER
+		unsigned long index;
+
+#if defined(_M_X64) || defined(_M_ARM64)
+		_BitScanForward64(&index, mask);
+#else
+		if (!_BitScanForward(&index, static_cast<uint32_t>(mask))) {
+			_BitScanForward(&index, static_cast<uint32_t>(mask >> 32));
+			index += 32;
+		}
+#endif
+		return index;
+#else
+		return __builtin_ctzll(mask);
+#endif
+	}
+
+	/*
+	 Bit i of the result is the XOR of bits 0 to i of x. Applied to the
+	 quote mask this sets every bit from an opening quote up to, but not
+	 including, the closing quote.
+	 */
+	inline uint64_t prefix_xor(uint64_t x) {
+		x ^= x << 1;
+		x ^= x << 2;
+		x ^= x << 4;
+		x ^= x << 8;
+		x ^= x << 16;
+		x ^= x << 32;
+
+		return x;
+	}
+
+	/*
+	 Returns the characters that are escaped by a backslash. A run of
+	 backslashes escapes every other character, so the parity of where each
+	 run starts decides which ones. prev_escaped carries an escape from the
+	 last byte of the previous block.
+	 */
+	inline uint64_t find_escaped(uint64_t backslash, uint64_t& prev_escaped) {
+		const uint64_t even_bits = 0x5555555555555555ULL;
+
+		backslash &= ~prev_escaped;
+
+		uint64_t follows_escape = backslash << 1 | prev_escaped;
+		uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+		uint64_t even_sequences = odd_starts + backslash;
+
+		//Carry out of the addition means the block ends in an open escape
+		prev_escaped = even_sequences < odd_starts ? 1 : 0;
+
+		uint64_t invert_mask = even_sequences << 1;
+
+		return (even_bits ^ invert_mask) & follows_escape;
+	}
+}
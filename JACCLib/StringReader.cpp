@@ -12,30 +12,5 @@ namespace jacc {
 		location = 0;
 	}
 
-	char StringReader::peek() {
-		if (location < data.size()) {
-			return data.at(location);
-		}
-		else {
-			return '\0';
-		}
-	}
-	char StringReader::pop() {
-		if (location < data.size()) {
-			char result = data.at(location);
-
-			++location;
-
-			return result;
-		}
-		else {
-			return '\0';
-		}
-	}
-
-	void StringReader::putback() {
-		if (location > 0) {
-			--location;
-		}
-	}
-}
\ No newline at end of file
+	template class BasicParser<StringReader>;
+}
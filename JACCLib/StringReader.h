@@ -11,11 +11,47 @@ namespace jacc {
 		StringReader();
 		StringReader(std::string_view source);
 
-		char peek();
-		char pop();
-		void putback();
+		//These are final and inline so that BasicParser<StringReader>
+		//can call them without going through the vtable.
+		char peek() final {
+			if (location < data.size()) {
+				return data[location];
+			}
+			else {
+				return '\0';
+			}
+		}
+
+		char pop() final {
+			if (location < data.size()) {
+				return data[location++];
+			}
+			else {
+				return '\0';
+			}
+		}
+
+		void putback() final {
+			if (location > 0) {
+				--location;
+			}
+		}
+
+		std::string_view window() final {
+			return std::string_view(data.data() + location, data.size() - location);
+		}
+
+		void consume(size_t n) final {
+			location += n;
+		}
+
+		bool persistent() final {
+			return true;
+		}
 
 		virtual ~StringReader();
 	};
+
+	extern template class BasicParser<StringReader>;
 }
 
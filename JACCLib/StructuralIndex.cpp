@@ -0,0 +1,183 @@
+#include "StructuralIndex.h"
+#include "Scanner.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace jacc {
+	/*
+	 Classifies data 64 bytes at a time and calls block(base, masks,
+	 quote, in_string) for each block, with the quotes that are not
+	 escaped and the bytes inside strings. Returns false if the data ends
+	 inside a string.
+	 */
+	template <typename Block>
+	static bool scan_blocks(std::string_view data, Block block) {
+		constexpr size_t BATCH = 64;
+
+		BlockMasks masks[BATCH];
+		uint64_t prev_escaped = 0;
+		uint64_t prev_in_string = 0;
+		size_t full_blocks = data.size() / 64;
+		size_t total_blocks = (data.size() + 63) / 64;
+
+		for (size_t first = 0; first < total_blocks; first += BATCH) {
+			size_t batch = std::min(BATCH, total_blocks - first);
+
+			if (first + batch <= full_blocks) {
+				classify_blocks(data.data() + first * 64, batch, masks);
+			}
+			else {
+				//Last block is padded with spaces
+				char tail[64];
+				size_t tail_start = full_blocks * 64;
+
+				std::memset(tail, ' ', sizeof(tail));
+				std::memcpy(tail, data.data() + tail_start, data.size() - tail_start);
+
+				classify_blocks(data.data() + first * 64, batch - 1, masks);
+				classify_blocks(tail, 1, masks + batch - 1);
+			}
+
+			for (size_t b = 0; b < batch; ++b) {
+				const BlockMasks& m = masks[b];
+				uint64_t escaped = find_escaped(m.backslash, prev_escaped);
+				uint64_t quote = m.quote & ~escaped;
+				uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+
+				prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+				block((first + b) * 64, m, quote, in_string);
+			}
+		}
+
+		return prev_in_string == 0;
+	}
+
+	bool StructuralIndex::build(std::string_view data) {
+		size_t count = 0;
+		//1 if the last byte of the previous block was part of a number or literal
+		uint64_t prev_scalar = 0;
+
+		error_code = ERROR_NONE;
+		error_message = nullptr;
+		positions.clear();
+
+		bool closed = scan_blocks(data, [&](size_t base, const BlockMasks& m, uint64_t quote, uint64_t in_string) {
+			//Bytes of numbers and literals, and where each of them starts
+			uint64_t scalar = ~(m.op | m.space | quote | in_string);
+			uint64_t scalar_start = scalar & ~(scalar << 1 | prev_scalar);
+
+			prev_scalar = scalar >> 63;
+
+			uint64_t structural = (m.op & ~in_string) | (quote & in_string) | scalar_start;
+
+			if (positions.size() < count + 64) {
+				positions.resize(std::max(positions.size() * 2, count + 64));
+			}
+
+			while (structural != 0) {
+				positions[count++] = base + trailing_zeros(structural);
+				structural &= structural - 1;
+			}
+		});
+
+		positions.resize(count);
+
+		if (!closed) {
+			error_code = ERROR_SYNTAX;
+			error_message = "Premature end of document while parsing string.";
+
+			return false;
+		}
+
+		return true;
+	}
+
+	bool StructuralIndex::split_array(std::string_view data) {
+		size_t depth = 0;
+		//Past the closing ']' of the root array
+		bool ended = false;
+
+		error_code = ERROR_NONE;
+		error_message = nullptr;
+		positions.clear();
+
+		const char* first = skip_space(data.data(), data.data() + data.size());
+
+		if (first == data.data() + data.size() || *first != '[') {
+			error_code = ERROR_SYNTAX;
+			error_message = "Document does not start with '['.";
+
+			return false;
+		}
+
+		bool closed = scan_blocks(data, [&](size_t base, const BlockMasks& m, uint64_t, uint64_t in_string) {
+			//Only brackets and commas matter here, elements are checked when
+			//they are parsed
+			uint64_t op = m.op & ~in_string;
+
+			while (op != 0 && !ended) {
+				size_t pos = base + trailing_zeros(op);
+
+				op &= op - 1;
+
+				switch (data[pos]) {
+				case '[':
+				case '{':
+					if (depth++ == 0) {
+						positions.push_back(pos);
+					}
+
+					break;
+				case ']':
+				case '}':
+					if (--depth == 0) {
+						positions.push_back(pos);
+						ended = true;
+					}
+
+					break;
+				case ',':
+					if (depth == 1) {
+						positions.push_back(pos);
+					}
+
+					break;
+				}
+			}
+		});
+
+		if (!closed) {
+			error_code = ERROR_SYNTAX;
+			error_message = "Premature end of document while parsing string.";
+
+			return false;
+		}
+
+		if (!ended) {
+			error_code = ERROR_SYNTAX;
+			error_message = "Premature end of documnent while parsing an array.";
+
+			return false;
+		}
+
+		size_t last = positions.back();
+
+		if (data[last] != ']') {
+			error_code = ERROR_SYNTAX;
+			error_message = "Invalid character in array.";
+
+			return false;
+		}
+
+		if (skip_space(data.data() + last + 1, data.data() + data.size()) != data.data() + data.size()) {
+			error_code = ERROR_SYNTAX;
+			error_message = "Unexpected data after the document.";
+
+			return false;
+		}
+
+		return true;
+	}
+}
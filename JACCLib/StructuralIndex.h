@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Parser.h"
+
+namespace jacc {
+	/*
+	 Stage 1 of two stage parsing. Finds, in one vectorized pass over an
+	 in-memory document, the offset of every structural character
+	 ({}[]:, outside of strings), every opening quote and the first byte of
+	 every number or literal. Escaped quotes are resolved, so the offsets
+	 never point inside a string. IndexedParser walks the result.
+	 */
+	struct StructuralIndex {
+		std::vector<size_t> positions;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+
+		bool build(std::string_view data);
+
+		/*
+		 For documents that are one big array. Finds only the '[' that
+		 opens the root array, every ',' between its elements and the ']'
+		 that closes it, so elements can be parsed independently. See
+		 ParallelArrayParser.
+		 */
+		bool split_array(std::string_view data);
+	};
+}
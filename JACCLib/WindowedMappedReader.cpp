@@ -0,0 +1,170 @@
+#include "WindowedMappedReader.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace jacc {
+	static size_t mapping_granularity() {
+#ifdef _WIN32
+		SYSTEM_INFO info;
+
+		::GetSystemInfo(&info);
+
+		return info.dwAllocationGranularity;
+#else
+		return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+	WindowedMappedReader::WindowedMappedReader(const char* file_name, size_t window) {
+		size_t granularity = mapping_granularity();
+
+		//At least two units so every region gets past the byte kept for putback()
+		window_size = (window + granularity - 1) / granularity * granularity;
+
+		if (window_size < 2 * granularity) {
+			window_size = 2 * granularity;
+		}
+
+#ifdef _WIN32
+		file_handle = ::CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+		if (file_handle == INVALID_HANDLE_VALUE) {
+			save_error(ERROR_IO, "Could not open the file.");
+
+			return;
+		}
+
+		LARGE_INTEGER size;
+
+		if (!::GetFileSizeEx(file_handle, &size)) {
+			save_error(ERROR_IO, "Could not get the size of the file.");
+
+			return;
+		}
+
+		file_size = static_cast<size_t>(size.QuadPart);
+
+		if (file_size > 0) {
+			map_handle = ::CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+			if (map_handle == NULL) {
+				save_error(ERROR_IO, "Could not map the file.");
+			}
+		}
+#else
+		file_handle = ::open(file_name, O_RDONLY);
+
+		if (file_handle < 0) {
+			save_error(ERROR_IO, "Could not open the file.");
+
+			return;
+		}
+
+		struct stat sbuf;
+
+		if (::fstat(file_handle, &sbuf) == -1) {
+			save_error(ERROR_IO, "Could not get the size of the file.");
+
+			return;
+		}
+
+		file_size = sbuf.st_size;
+#endif
+	}
+
+	WindowedMappedReader::~WindowedMappedReader() {
+		unmap();
+
+#ifdef _WIN32
+		if (map_handle != NULL) {
+			::CloseHandle(map_handle);
+		}
+		if (file_handle != INVALID_HANDLE_VALUE) {
+			::CloseHandle(file_handle);
+		}
+#else
+		if (file_handle >= 0) {
+			::close(file_handle);
+		}
+#endif
+	}
+
+	void WindowedMappedReader::save_error(ErrorCode code, const char* msg) {
+		error_code = code;
+		error_message = msg;
+	}
+
+	void WindowedMappedReader::unmap() {
+		if (map == nullptr) {
+			return;
+		}
+
+#ifdef _WIN32
+		::UnmapViewOfFile(map);
+#else
+		::munmap((void*) map, map_length);
+#endif
+
+		map = nullptr;
+	}
+
+	/*
+	 Maps the region after the current one. It starts at the mapping unit
+	 holding the last byte read, so a putback() right after advancing
+	 still works. Returns false at the end of the file or on error.
+	 */
+	bool WindowedMappedReader::advance() {
+		size_t position = map_offset + location;
+
+		if (error_code != ERROR_NONE || position >= file_size) {
+			return false;
+		}
+
+		size_t granularity = mapping_granularity();
+		size_t keep = position > 0 ? position - 1 : 0;
+		size_t offset = keep - keep % granularity;
+		size_t length = file_size - offset < window_size ? file_size - offset : window_size;
+
+		unmap();
+
+#ifdef _WIN32
+		ULARGE_INTEGER start;
+
+		start.QuadPart = offset;
+
+		const char* region = (const char*) ::MapViewOfFile(map_handle, FILE_MAP_READ, start.HighPart, start.LowPart, length);
+
+		if (region == NULL) {
+			map_length = location = 0;
+			save_error(ERROR_IO, "Could not map the file.");
+
+			return false;
+		}
+#else
+		void* region = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, file_handle, static_cast<off_t>(offset));
+
+		if (region == MAP_FAILED) {
+			map_length = location = 0;
+			save_error(ERROR_IO, "Could not map the file.");
+
+			return false;
+		}
+
+		::madvise(region, length, MADV_SEQUENTIAL);
+#endif
+
+		map = static_cast<const char*>(region);
+		map_offset = offset;
+		map_length = length;
+		location = position - offset;
+
+		return location < map_length;
+	}
+
+	template class BasicParser<WindowedMappedReader>;
+}
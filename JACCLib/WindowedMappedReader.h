@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Parser.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif // _WIN32
+
+namespace jacc {
+	/*
+	 Reads a file through a mapping of a bounded region that slides forward
+	 as the parser consumes input. The previous region is unmapped when
+	 the next one is mapped, so resident memory stays around window_size
+	 no matter how big the file is. Use it for files too large to map as a
+	 whole. Like FileReader it is not persistent, parsed values can not
+	 point into the input, and putback() works within the current region.
+	 */
+	struct WindowedMappedReader :
+		public Reader
+	{
+		static constexpr size_t WINDOW_SIZE = 64 * 1024 * 1024;
+
+#ifdef _WIN32
+		HANDLE file_handle = INVALID_HANDLE_VALUE;
+		HANDLE map_handle = NULL;
+#endif
+#ifndef _WIN32
+		int file_handle = -1;
+#endif
+		size_t file_size = 0;
+		//Size of each mapped region, a multiple of the mapping granularity
+		size_t window_size = 0;
+		const char* map = nullptr;
+		//File offset and length of the current region
+		size_t map_offset = 0;
+		size_t map_length = 0;
+		//Read position within the current region
+		size_t location = 0;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+
+		WindowedMappedReader(const char* file_name, size_t window = WINDOW_SIZE);
+
+		WindowedMappedReader(const WindowedMappedReader&) = delete;
+		WindowedMappedReader& operator=(const WindowedMappedReader&) = delete;
+
+		bool advance();
+		void unmap();
+		void save_error(ErrorCode code, const char* msg);
+
+		char peek() final {
+			if (location < map_length || advance()) {
+				return map[location];
+			}
+
+			return '\0';
+		}
+
+		char pop() final {
+			if (location < map_length || advance()) {
+				return map[location++];
+			}
+
+			return '\0';
+		}
+
+		void putback() final {
+			if (location > 0) {
+				--location;
+			}
+		}
+
+		std::string_view window() final {
+			if (location < map_length || advance()) {
+				return std::string_view(map + location, map_length - location);
+			}
+
+			return {};
+		}
+
+		void consume(size_t n) final {
+			location += n;
+		}
+
+		virtual ~WindowedMappedReader();
+	};
+
+	extern template class BasicParser<WindowedMappedReader>;
+}
@@ -0,0 +1,98 @@
+#include "ZstdReader.h"
+
+#ifdef JACC_WITH_ZSTD
+
+namespace jacc {
+	ZstdReader::ZstdReader(const char* file_name, size_t buffer_size) : source(file_name), buffer(buffer_size < 2 ? 2 : buffer_size) {
+		init();
+	}
+
+	ZstdReader::ZstdReader(int descriptor, size_t buffer_size, bool own) : source(descriptor, FileReader::BUFFER_SIZE, own), buffer(buffer_size < 2 ? 2 : buffer_size) {
+		init();
+	}
+
+	ZstdReader::~ZstdReader() {
+		::ZSTD_freeDCtx(context);
+	}
+
+	void ZstdReader::init() {
+		context = ::ZSTD_createDCtx();
+
+		if (context == nullptr) {
+			save_error(ERROR_IO, "Could not initialize zstd.");
+		}
+		else if (!source.is_open()) {
+			save_error(ERROR_IO, "Could not open the file.");
+		}
+	}
+
+	void ZstdReader::save_error(ErrorCode code, const char* msg) {
+		error_code = code;
+		error_message = msg;
+	}
+
+	/*
+	 Decompresses the next block. As in FileReader the last byte of the
+	 previous block is kept at the front for putback().
+	 */
+	bool ZstdReader::fill() {
+		if (error_code != ERROR_NONE) {
+			return false;
+		}
+
+		if (length > 0) {
+			buffer[0] = buffer[length - 1];
+			location = 1;
+		}
+		else {
+			location = 0;
+		}
+
+		length = location;
+
+		while (length == location) {
+			std::string_view in = source.window();
+
+			if (in.empty() && pending == 0) {
+				//End of input between frames, or a read error
+				if (source.error_code != ERROR_NONE) {
+					save_error(source.error_code, source.error_message);
+				}
+
+				break;
+			}
+
+			ZSTD_inBuffer input = { in.data(), in.size(), 0 };
+			ZSTD_outBuffer output = { buffer.data(), buffer.size(), length };
+
+			pending = ::ZSTD_decompressStream(context, &output, &input);
+
+			if (::ZSTD_isError(pending)) {
+				save_error(ERROR_IO, "Compressed stream is corrupt.");
+
+				break;
+			}
+
+			source.consume(input.pos);
+			length = output.pos;
+
+			if (in.empty() && length == location) {
+				//No input left and nothing came out
+				if (source.error_code != ERROR_NONE) {
+					save_error(source.error_code, source.error_message);
+				}
+				else {
+					save_error(ERROR_IO, "Compressed stream is truncated.");
+				}
+
+				break;
+			}
+		}
+
+		return length > location;
+	}
+
+	template class BasicParser<ZstdReader>;
+}
+
+#endif
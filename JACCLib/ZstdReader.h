@@ -0,0 +1,79 @@
+#pragma once
+
+//Needs libzstd. Define JACC_WITH_ZSTD and link with libzstd to build it.
+#ifdef JACC_WITH_ZSTD
+
+#include "FileReader.h"
+#include <zstd.h>
+
+namespace jacc {
+	/*
+	 Decompresses a zstd stream while it is parsed, see GzipReader.
+	 Multiple frames are read as one stream.
+	 */
+	struct ZstdReader :
+		public Reader
+	{
+		static constexpr size_t BUFFER_SIZE = 256 * 1024;
+
+		FileReader source;
+		ZSTD_DCtx* context = nullptr;
+		//Result of the last ZSTD_decompressStream(), 0 at the end of a frame
+		size_t pending = 0;
+		std::vector<char> buffer;
+		size_t location = 0;
+		size_t length = 0;
+		ErrorCode error_code = ERROR_NONE;
+		const char* error_message = nullptr;
+
+		ZstdReader(const char* file_name, size_t buffer_size = BUFFER_SIZE);
+		ZstdReader(int descriptor, size_t buffer_size = BUFFER_SIZE, bool own = false);
+
+		ZstdReader(const ZstdReader&) = delete;
+		ZstdReader& operator=(const ZstdReader&) = delete;
+
+		void init();
+		bool fill();
+		void save_error(ErrorCode code, const char* msg);
+
+		char peek() final {
+			if (location < length || fill()) {
+				return buffer[location];
+			}
+
+			return '\0';
+		}
+
+		char pop() final {
+			if (location < length || fill()) {
+				return buffer[location++];
+			}
+
+			return '\0';
+		}
+
+		void putback() final {
+			if (location > 0) {
+				--location;
+			}
+		}
+
+		std::string_view window() final {
+			if (location < length || fill()) {
+				return std::string_view(buffer.data() + location, length - location);
+			}
+
+			return {};
+		}
+
+		void consume(size_t n) final {
+			location += n;
+		}
+
+		virtual ~ZstdReader();
+	};
+
+	extern template class BasicParser<ZstdReader>;
+}
+
+#endif
@@ -1,11 +1,32 @@
 #include <iostream>
 #include <Parser.h>
+#include <Scanner.h>
 #include <StringReader.h>
 #include <FileReader.h>
 #include <MemoryMappedReader.h>
+#include <IndexedParser.h>
+#include <RecordStream.h>
+#include <ParallelRecords.h>
+#include <ParallelArray.h>
+#include <ArrayStream.h>
+#include <Document.h>
+#include <Arena.h>
+#include <WindowedMappedReader.h>
+#include <GzipReader.h>
+#include <ZstdReader.h>
+#include <SaxHandler.h>
+#include <OnDemand.h>
+#include <PushParser.h>
 #include <assert.h>
 #include <cmath>
+#include <cstring>
 #include <fstream>
+#include <memory_resource>
+#include <thread>
+#include <algorithm>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 #include "Test.h"
 
@@ -388,6 +409,2009 @@ void test_type_operators() {
     assert(s2 == "Hello");
 }
 
+void test_basic_parser() {
+    const char* json = R"(
+{
+  "name": "Bugs Bunny",
+  "likes": ["Carrot", "Singing"],
+  "age": 10
+}
+)";
+    jacc::StringReader reader(json);
+    jacc::BasicParser p(reader);
+
+    auto root = p.parse();
+
+    assert(p.error_code == jacc::ERROR_NONE);
+    assert(root["likes"][1].string() == "Singing");
+    assert(root["age"].number() == 10);
+
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name);
+
+        test_file << json;
+    } //Closes file
+
+    {
+        jacc::MemoryMappedReader mm_reader(file_name);
+        jacc::BasicParser<jacc::MemoryMappedReader> mm_parser(mm_reader);
+
+        auto mm_root = mm_parser.parse();
+
+        assert(mm_parser.error_code == jacc::ERROR_NONE);
+        assert(mm_root["name"].string() == "Bugs Bunny");
+    } //Closes file
+
+    {
+        jacc::FileReader f_reader(file_name);
+        jacc::BasicParser f_parser(f_reader);
+
+        auto f_root = f_parser.parse();
+
+        assert(f_parser.error_code == jacc::ERROR_NONE);
+        assert(f_root["likes"][0].string() == "Carrot");
+    } //Closes file
+
+    std::remove(file_name);
+}
+
+void test_reader_window() {
+    jacc::StringReader reader("[1, 2]");
+
+    assert(reader.window() == "[1, 2]");
+
+    reader.consume(3);
+
+    assert(reader.window() == " 2]");
+    assert(reader.pop() == ' ');
+
+    //An embedded NUL inside a string is an unescaped control character,
+    //not the end of input
+    const char json[] = "[\"a\0b\"]";
+    jacc::StringReader nul_reader(std::string_view(json, sizeof(json) - 1));
+    jacc::Parser p(nul_reader);
+
+    p.parse();
+
+    assert(p.error_code == jacc::ERROR_SYNTAX);
+    assert(std::string(p.error_message) == "Unescaped control character in string.");
+}
+
+void test_file_reader_refill() {
+    //Values straddle the FileReader buffer boundary
+    std::string long_value(jacc::FileReader::BUFFER_SIZE + 100, 'x');
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name);
+
+        test_file << "[\"" << long_value << "\", 12345, \"" << long_value << "\"]";
+    } //Closes file
+
+    {
+        jacc::FileReader reader(file_name);
+        jacc::BasicParser p(reader);
+
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root.array().size() == 3);
+        assert(root[0].string() == long_value);
+        assert(root[1].number() == 12345);
+        assert(root[2].string() == long_value);
+    } //Closes file
+
+    std::remove(file_name);
+}
+
+void test_long_strings() {
+    //Long enough to take the vectorized path, with specials at every offset
+    std::string plain(100, 'a');
+
+    for (size_t i = 0; i < 70; ++i) {
+        std::string expected = plain.substr(0, i) + "\"" + plain.substr(i) + "\u00e9";
+        std::string json = "[\"" + plain.substr(0, i) + "\\\"" + plain.substr(i) + "\\u00E9\"]";
+        jacc::StringReader reader(json);
+        jacc::Parser p(reader);
+
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root[0].string() == expected);
+    }
+
+    std::string bad = "[\"" + plain + "\t" + plain + "\"]";
+    jacc::StringReader reader(bad);
+    jacc::Parser p(reader);
+
+    p.parse();
+
+    assert(p.error_code == jacc::ERROR_SYNTAX);
+
+    jacc::StringReader hex_reader("00zz");
+    jacc::Parser hex_parser(hex_reader);
+
+    hex_parser.read_codepoint();
+
+    assert(hex_parser.error_code == jacc::ERROR_SYNTAX);
+}
+
+void test_scanner_isa() {
+    const char* json = R"(
+{
+    "name"   :    "Bugs Bunny",
+    "active":true
+        ,
+    "scores": [ 10 , 20.5,
+                -3e2 ],
+    "manager": null
+}
+)";
+    jacc::Isa all[] = {jacc::ISA_SCALAR, jacc::ISA_NEON, jacc::ISA_SSE42, jacc::ISA_AVX2, jacc::ISA_AVX512};
+
+    for (jacc::Isa isa : all) {
+        if (!jacc::force_isa(isa)) {
+            continue;
+        }
+
+        assert(jacc::active_isa() == isa);
+
+        //Find a character at every position of buffers of different sizes
+        for (size_t size = 0; size < 150; ++size) {
+            for (size_t pos = 0; pos <= size; ++pos) {
+                std::string spaces(size, ' ');
+                std::string letters(size, 'a');
+
+                if (pos < size) {
+                    spaces[pos] = 'x';
+                    letters[pos] = pos % 2 ? ']' : '\t';
+                }
+
+                const char* s_end = spaces.data() + size;
+                const char* l_end = letters.data() + size;
+
+                assert(jacc::skip_space(spaces.data(), s_end) == spaces.data() + pos);
+                assert(jacc::find_token_end(letters.data(), l_end) == letters.data() + pos);
+
+                if (pos < size) {
+                    letters[pos] = pos % 2 ? '"' : '\x01';
+                }
+
+                assert(jacc::find_string_special(letters.data(), l_end) == letters.data() + pos);
+            }
+        }
+
+        jacc::StringReader reader(json);
+        jacc::BasicParser p(reader);
+
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root["active"].boolean());
+        assert(root["scores"][2].number() == -300);
+        assert(root["manager"].isNull());
+    }
+
+    jacc::force_isa(jacc::detected_isa());
+}
+
+bool json_equals(jacc::JSONObject& a, jacc::JSONObject& b) {
+    //Compare kinds, not variant alternatives, so a packed array equals
+    //the same array unpacked
+    if (a.isUndefined() != b.isUndefined() || a.isNull() != b.isNull() ||
+        a.isString() != b.isString() || a.isNumber() != b.isNumber() ||
+        a.isBoolean() != b.isBoolean() || a.isArray() != b.isArray() ||
+        a.isObject() != b.isObject()) {
+        return false;
+    }
+
+    if (a.isString()) {
+        return a.string() == b.string();
+    }
+    if (a.isNumber()) {
+        return a.number() == b.number();
+    }
+    if (a.isBoolean()) {
+        return a.boolean() == b.boolean();
+    }
+    if (a.isArray()) {
+        if (a.array().size() != b.array().size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.array().size(); ++i) {
+            if (!json_equals(a[i], b[i])) {
+                return false;
+            }
+        }
+    }
+    if (a.isObject()) {
+        if (a.object().size() != b.object().size()) {
+            return false;
+        }
+        for (auto& member : a.object()) {
+            if (b.object().count(member.first) == 0 || !json_equals(member.second, b[member.first])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void test_indexed_parser() {
+    jacc::Isa all[] = {jacc::ISA_SCALAR, jacc::ISA_NEON, jacc::ISA_SSE42, jacc::ISA_AVX2, jacc::ISA_AVX512};
+
+    for (jacc::Isa isa : all) {
+        if (!jacc::force_isa(isa)) {
+            continue;
+        }
+
+        //Move escapes and quotes across the 64 byte block boundaries
+        for (size_t pad = 0; pad < 130; ++pad) {
+            std::string json = "{\"" + std::string(pad, 'p') + "\": [\"a\\\\\", \"b\\\"}\\\\\\\"\", true, null,";
+
+            json += "-12.5e1, {\"x\" : \"{[:,]}\"}, [], {}, \"" + std::string(2 * (pad % 35), '\\') + "\"], \"k\":false}";
+
+            jacc::StringReader reader1(json);
+            jacc::Parser p1(reader1);
+            auto expected = p1.parse();
+
+            assert(p1.error_code == jacc::ERROR_NONE);
+
+            jacc::StringReader reader2(json);
+            jacc::IndexedParser p2(reader2);
+            auto root = p2.parse();
+
+            assert(p2.error_code == jacc::ERROR_NONE);
+            assert(json_equals(expected, root));
+            assert(root[std::string(pad, 'p')][1].string() == "b\"}\\\"");
+        }
+    }
+
+    jacc::force_isa(jacc::detected_isa());
+
+    const char* bad[] = {"[1, 2", "{\"a\" 1}", "[1 2]", "{\"a\": }", "[\"abc]", "{\"a\":1,}", "1"};
+
+    for (const char* json : bad) {
+        jacc::StringReader reader(json);
+        jacc::IndexedParser p(reader);
+
+        p.parse();
+
+        assert(p.error_code == jacc::ERROR_SYNTAX);
+    }
+}
+
+void test_escapes_and_whitespace() {
+    const char* json = "[\"a\\/b\\f\\b\\t\\r\\n\\\"\\\\\"]";
+    jacc::StringReader reader(json);
+    jacc::Parser p(reader);
+
+    auto root = p.parse();
+
+    assert(p.error_code == jacc::ERROR_NONE);
+    assert(root[0].string() == "a/b\f\b\t\r\n\"\\");
+
+    //Only JSON whitespace is skipped, not everything isspace() accepts
+    const char* bad[] = {"[\"\\x\"]", "[1,\v2]", "[\f1]"};
+
+    for (const char* bad_json : bad) {
+        jacc::StringReader bad_reader(bad_json);
+        jacc::Parser bad_parser(bad_reader);
+
+        bad_parser.parse();
+
+        assert(bad_parser.error_code == jacc::ERROR_SYNTAX);
+    }
+}
+
+void test_zero_copy() {
+    const char* json = R"({"name": "Bugs Bunny", "quote": "What is up \"Doc\"?", "likes": ["Carrot"]})";
+    jacc::StringReader reader(json);
+    jacc::ParseOptions options;
+
+    options.zero_copy = true;
+
+    jacc::BasicParser p(reader, options);
+
+    auto root = p.parse();
+
+    assert(p.error_code == jacc::ERROR_NONE);
+    //Unescaped strings point into the input
+    assert(std::holds_alternative<std::string_view>(root["name"].value));
+    assert(root["name"].view().data() > json && root["name"].view().data() < json + strlen(json));
+    assert(root["name"].view() == "Bugs Bunny");
+    assert(root["likes"][0].isString());
+    //Strings with escapes are decoded into a std::string
+    assert(std::holds_alternative<std::string>(root["quote"].value));
+    assert(root["quote"].view() == "What is up \"Doc\"?");
+    //string() still works and makes a copy
+    assert(root["name"].string() == "Bugs Bunny");
+    assert(std::holds_alternative<std::string>(root["name"].value));
+
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name);
+
+        test_file << json;
+    } //Closes file
+
+    {
+        jacc::Document doc(file_name);
+
+        assert(doc.error_code == jacc::ERROR_NONE);
+
+        jacc::Document moved(std::move(doc));
+
+        assert(moved.root["likes"][0].view() == "Carrot");
+        assert(std::holds_alternative<std::string_view>(moved.root["likes"][0].value));
+    } //Closes file
+
+    std::remove(file_name);
+}
+
+void test_arena() {
+    const char* json = R"({"name": "Bugs Bunny", "quote": "What is up \"Doc\"?", "likes": ["Carrot", 1, true], "friends": {"Daffy": "Duck"}})";
+
+    for (bool huge_pages : {false, true}) {
+        jacc::Arena arena(4096, huge_pages);
+        jacc::StringReader reader(json);
+        jacc::ParseOptions options;
+
+        options.resource = &arena.resource;
+
+        jacc::BasicParser p(reader, options);
+
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        //Strings are views into the arena, not into the input
+        assert(std::holds_alternative<std::string_view>(root["name"].value));
+        assert(root["name"].view() == "Bugs Bunny");
+        assert(root["name"].view().data() < json || root["name"].view().data() >= json + strlen(json));
+        assert(root["quote"].view() == "What is up \"Doc\"?");
+        assert(root["likes"].array().size() == 3);
+        assert(root["likes"][0].view() == "Carrot");
+        assert(root["likes"][1].number() == 1.0);
+        assert(root["friends"]["Daffy"].view() == "Duck");
+        assert(root.object().get_allocator().resource() == &arena.resource);
+
+        //Indexed parser uses the same option
+        jacc::StringReader indexed_reader(json);
+        jacc::IndexedParser ip(indexed_reader, options);
+
+        auto indexed_root = ip.parse();
+
+        assert(ip.error_code == jacc::ERROR_NONE);
+        assert(json_equals(root, indexed_root));
+    }
+
+    //Page alignment is met, larger alignments are refused
+    jacc::PageResource pages;
+    void* page = pages.allocate(100, 4096);
+
+    assert(reinterpret_cast<uintptr_t>(page) % 4096 == 0);
+    pages.deallocate(page, 100, 4096);
+
+    bool refused = false;
+
+    try {
+        page = pages.allocate(100, 8192);
+    }
+    catch (const std::bad_alloc&) {
+        refused = true;
+    }
+
+    assert(refused);
+}
+
+void test_object_map() {
+    //Members keep document order
+    jacc::StringReader reader(R"({"zebra": 1, "apple": 2, "mango": 3, "apple": 4})");
+    jacc::Parser p(reader);
+
+    auto root = p.parse();
+
+    assert(p.error_code == jacc::ERROR_NONE);
+    assert(root.object().size() == 3);
+
+    const char* order[] = {"zebra", "apple", "mango"};
+    size_t i = 0;
+
+    for (auto& member : root.object()) {
+        assert(member.first == order[i++]);
+    }
+
+    //Duplicate keys keep the first value, as with std::map
+    assert(root["apple"].number() == 2.0);
+    assert(root.object().count("banana") == 0);
+    assert(root.object().find("banana") == root.object().end());
+
+    //Large objects switch to hashed lookup
+    std::string json = "{";
+
+    for (int n = 0; n < 100; ++n) {
+        json += (n ? ", " : "") + std::string("\"key") + std::to_string(n) + "\": " + std::to_string(n);
+    }
+
+    json += "}";
+
+    jacc::StringReader big_reader(json.c_str());
+    jacc::Parser big_parser(big_reader);
+
+    auto big = big_parser.parse();
+
+    assert(big_parser.error_code == jacc::ERROR_NONE);
+    assert(big.object().size() == 100);
+
+    for (int n = 0; n < 100; ++n) {
+        assert(big.object().count("key" + std::to_string(n)) == 1);
+        assert(big["key" + std::to_string(n)].number() == n);
+    }
+
+    assert(big.object().count("key100") == 0);
+    assert(big.object().begin()->first == "key0");
+
+    //operator[] adds missing members after the hash index is built
+    big["extra"] = jacc::JSONObject(true);
+
+    assert(big.object().size() == 101);
+    assert(big["extra"].boolean());
+    assert(big["key42"].number() == 42.0);
+}
+
+void test_numbers() {
+    const char* json = R"([0, -0, 42, -17, 9007199254740993, 9223372036854775807, -9223372036854775808, 18446744073709551615, 18446744073709551616, 1.5, -2.5e3, 1E-2, 6.02214076e23])";
+    jacc::StringReader reader(json);
+    jacc::BasicParser p(reader);
+
+    auto root = p.parse();
+
+    assert(p.error_code == jacc::ERROR_NONE);
+    assert(root[0].isInteger() && root[0].int64() == 0);
+    //-0 keeps its sign, which only a double can hold
+    assert(!root[1].isInteger() && root[1].number() == 0.0 && std::signbit(root[1].number()));
+    assert(root[2].int64() == 42 && root[2].uint64() == 42);
+    assert(root[3].int64() == -17);
+    assert(root[3].number() == -17.0);
+    //Above 2^53, would be rounded as a double
+    assert(root[4].int64() == 9007199254740993LL);
+    assert(root[5].int64() == INT64_MAX);
+    assert(root[6].int64() == INT64_MIN);
+    assert(std::holds_alternative<uint64_t>(root[7].value));
+    assert(root[7].uint64() == UINT64_MAX);
+    //Too big for any integer type
+    assert(std::holds_alternative<double>(root[8].value));
+    assert(number_equals(root[8].number(), 18446744073709551616.0));
+    assert(!root[9].isInteger() && root[9].isNumber());
+    assert(root[9].number() == 1.5);
+    assert(root[10].number() == -2500.0);
+    assert(number_equals(root[11].number(), 0.01));
+    assert(number_equals(root[12].number(), 6.02214076e23));
+
+    //Same results through virtual reader calls
+    jacc::StringReader virtual_reader(json);
+    jacc::Parser vp(virtual_reader);
+
+    auto vroot = vp.parse();
+
+    assert(vp.error_code == jacc::ERROR_NONE);
+    assert(json_equals(root, vroot));
+    assert(vroot[7].uint64() == UINT64_MAX);
+
+    //Too small numbers become zero or a denormal, only too large ones fail
+    const char* tiny[] = {"1e-400", "-1e-400", "0.0000001e-320", "1e-310", "4.9e-324", "2e-324", "123456789e-340", "100000e-2000000000000000000"};
+
+    for (const char* text : tiny) {
+        jacc::Number n = jacc::scan_number(text, text + strlen(text));
+
+        assert(n.type == jacc::NUMBER_DOUBLE);
+        assert(n.d == 0.0 || std::fpclassify(n.d) == FP_SUBNORMAL);
+        assert(std::signbit(n.d) == (text[0] == '-'));
+    }
+
+    for (const char* text : {"1e400", "-1e400", "0.001e312", "1000e99999999999999999999"}) {
+        assert(jacc::scan_number(text, text + strlen(text)).type == jacc::NUMBER_OUT_OF_RANGE);
+    }
+
+    const char* invalid[] = {"[01]", "[+1]", "[1.]", "[.5]", "[1e]", "[1e+]", "[-]", "[12abc]", "[0x10]", "[1.5.2]", "[1e999]"};
+
+    for (const char* bad : invalid) {
+        jacc::StringReader bad_reader(bad);
+        jacc::BasicParser bad_parser(bad_reader);
+
+        bad_parser.parse();
+
+        assert(bad_parser.error_code == jacc::ERROR_SYNTAX);
+    }
+}
+
+void test_lazy_numbers() {
+    const char* json = R"({"price": 19.990, "id": 18446744073709551615, "big": 1e999, "count": -3})";
+    jacc::StringReader reader(json);
+    jacc::ParseOptions options;
+
+    options.lazy_numbers = true;
+
+    jacc::BasicParser p(reader, options);
+
+    auto root = p.parse();
+
+    assert(p.error_code == jacc::ERROR_NONE);
+    assert(std::holds_alternative<jacc::RawNumber>(root["price"].value));
+    //Exact source text, trailing zero included, points into the input
+    assert(root["price"].number_text() == "19.990");
+    assert(root["price"].number_text().data() > json);
+    assert(root["price"].isNumber() && !root["price"].isInteger());
+    assert(root["price"].number() == 19.99);
+    assert(root["id"].isInteger() && root["id"].uint64() == UINT64_MAX);
+    assert(root["count"].int64() == -3);
+    assert(root["count"].number() == -3.0);
+    assert(std::holds_alternative<jacc::RawNumber>(root["count"].value));
+
+    bool thrown = false;
+
+    try {
+        root["big"].number();
+    }
+    catch (const std::out_of_range&) {
+        thrown = true;
+    }
+
+    assert(thrown);
+
+    //Grammar is still checked while parsing
+    jacc::StringReader bad_reader("[1.]");
+    jacc::BasicParser bad_parser(bad_reader, options);
+
+    bad_parser.parse();
+
+    assert(bad_parser.error_code == jacc::ERROR_SYNTAX);
+
+    //Input that does not persist: text is copied into the arena
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name);
+
+        test_file << json;
+    } //Closes file
+
+    {
+        jacc::Arena arena;
+        jacc::FileReader file_reader(file_name);
+
+        options.resource = &arena.resource;
+
+        jacc::BasicParser fp(file_reader, options);
+
+        auto froot = fp.parse();
+
+        assert(fp.error_code == jacc::ERROR_NONE);
+        assert(froot["price"].number_text() == "19.990");
+        assert(froot["id"].uint64() == UINT64_MAX);
+
+        //Without a place to keep the text numbers are converted right
+        //away, so the out of range one fails the parse
+        jacc::FileReader eager_reader(file_name);
+        jacc::ParseOptions eager_options;
+
+        eager_options.lazy_numbers = true;
+
+        jacc::BasicParser ep(eager_reader, eager_options);
+
+        auto eroot = ep.parse();
+
+        assert(ep.error_code == jacc::ERROR_SYNTAX);
+    } //Closes file
+
+    std::remove(file_name);
+}
+
+void test_packed_arrays() {
+    const char* json = R"({"ids": [3, -1, 9223372036854775807], "points": [1.11, 3, -10, 4.44], "flags": [true, false, true], "mixed": [1, 2.5, "three"], "huge": [9007199254740993, 0.5], "empty": []})";
+    jacc::ParseOptions options;
+
+    options.pack_arrays = true;
+
+    jacc::StringReader reader(json);
+    jacc::BasicParser p(reader, options);
+
+    auto root = p.parse();
+
+    assert(p.error_code == jacc::ERROR_NONE);
+    assert(root["ids"].isPacked() && root["ids"].isArray());
+    assert(root["ids"].integers().size() == 3);
+    assert(root["ids"].integers()[2] == INT64_MAX);
+
+    //Contiguous storage, integers become doubles
+    auto& points = root["points"].doubles();
+    const double* data = points.data();
+
+    assert(points.size() == 4);
+    assert(data[0] == 1.11 && data[1] == 3.0 && data[2] == -10.0 && data[3] == 4.44);
+
+    //One byte per boolean
+    auto& flags = root["flags"].booleans();
+    const uint8_t* bytes = flags.data();
+
+    assert(flags.size() == 3);
+    assert(bytes[0] == 1 && bytes[1] == 0 && bytes[2] == 1);
+
+    //Other element types fall back to a regular Array
+    assert(!root["mixed"].isPacked());
+    assert(root["mixed"].array().size() == 3);
+    assert(root["mixed"][2].view() == "three");
+    //An integer a double can not hold exactly stops packing
+    assert(!root["huge"].isPacked());
+    assert(root["huge"][0].int64() == 9007199254740993LL);
+    assert(!root["empty"].isPacked() && root["empty"].array().empty());
+
+    //Element access unpacks
+    assert(root["points"][3].number() == 4.44);
+    assert(!root["points"].isPacked());
+    assert(root["flags"][2].boolean());
+    assert(root["ids"][1].int64() == -1);
+
+    //Same result as the unpacked parse
+    jacc::StringReader plain_reader(json);
+    jacc::BasicParser plain(plain_reader);
+    auto plain_root = plain.parse();
+
+    jacc::StringReader indexed_reader(json);
+    jacc::IndexedParser ip(indexed_reader, options);
+    auto indexed_root = ip.parse();
+
+    assert(ip.error_code == jacc::ERROR_NONE);
+    assert(indexed_root["points"].isPacked());
+    assert(json_equals(plain_root, indexed_root));
+    assert(json_equals(plain_root, root));
+}
+
+void test_file_reader_fd() {
+    const char* json = R"({"values": [1.5, 12345, -7], "name": "Bugs Bunny", "nested": {"ok": true}})";
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name);
+
+        test_file << json;
+    } //Closes file
+
+    //Tiny buffers put every token across refills
+    for (size_t size : {2, 3, 7, 16}) {
+        jacc::FileReader reader(file_name, size);
+        jacc::BasicParser p(reader);
+
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root["values"][1].int64() == 12345);
+        assert(root["name"].string() == "Bugs Bunny");
+        assert(root["nested"]["ok"].boolean());
+    } //Closes file
+
+    std::remove(file_name);
+
+    jacc::FileReader missing("__missing.json");
+
+    assert(!missing.is_open());
+    assert(missing.error_code == jacc::ERROR_IO);
+
+#ifndef _WIN32
+    //A pipe delivers the document in short reads
+    int fds[2];
+    int piped = pipe(fds);
+
+    assert(piped == 0);
+
+    std::thread writer([&]() {
+        for (const char* p = json; *p; p += 5) {
+            size_t n = std::min<size_t>(5, strlen(p));
+
+            ssize_t written = write(fds[1], p, n);
+
+            assert(written == static_cast<ssize_t>(n));
+
+            if (n < 5) {
+                break;
+            }
+        }
+
+        close(fds[1]);
+    });
+
+    {
+        jacc::FileReader reader(fds[0], 4096, true);
+        jacc::BasicParser p(reader);
+
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root["values"][0].number() == 1.5);
+        assert(root["nested"]["ok"].boolean());
+    } //Closes the read end
+
+    writer.join();
+
+    //A failed read is an error, not the end of input
+    {
+        jacc::FileReader reader(".");
+        jacc::BasicParser p(reader);
+
+        assert(reader.is_open());
+
+        p.parse();
+
+        assert(p.error_code == jacc::ERROR_SYNTAX);
+        assert(reader.error_code == jacc::ERROR_IO);
+    }
+#endif
+}
+
+void test_memory_map_strategy() {
+    const char* json = R"({"name": "Bugs Bunny", "likes": ["Carrot"]})";
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name);
+
+        test_file << json;
+    } //Closes file
+
+    {
+        //Small files are read
+        jacc::MemoryMappedReader reader(file_name);
+
+        assert(reader.error_code == jacc::ERROR_NONE);
+        assert(reader.strategy == jacc::INPUT_READ);
+        assert(reader.data == json);
+
+        jacc::MappingOptions options;
+
+        options.read_threshold = 0;
+        options.populate = true;
+
+        jacc::MemoryMappedReader mapped(file_name, options);
+
+        assert(mapped.error_code == jacc::ERROR_NONE);
+        assert(mapped.strategy == jacc::INPUT_MMAP);
+
+        jacc::BasicParser p(mapped);
+
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root["likes"][0].string() == "Carrot");
+    } //Closes file
+
+    std::remove(file_name);
+
+    jacc::MemoryMappedReader missing("__missing.json");
+
+    assert(missing.error_code == jacc::ERROR_IO);
+    assert(missing.strategy == jacc::INPUT_NONE);
+    assert(missing.data.empty());
+
+    jacc::Document doc("__missing.json");
+
+    assert(doc.error_code == jacc::ERROR_IO);
+}
+
+void test_windowed_mapped_reader() {
+    const char* file_name = "__test.json";
+    std::string json = "[";
+
+    //Strings, numbers and escapes land across every region boundary
+    for (int i = 0; i < 5000; ++i) {
+        json += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) +
+            ", \"name\": \"item \\\"" + std::to_string(i) + "\\\"\", \"price\": " + std::to_string(i) + ".25}";
+    }
+
+    json += "]";
+
+    {
+        std::ofstream test_file(file_name, std::ios::binary);
+
+        test_file << json;
+    } //Closes file
+
+    {
+        jacc::WindowedMappedReader reader(file_name, 1);
+
+        assert(reader.error_code == jacc::ERROR_NONE);
+        assert(reader.file_size == json.size());
+        assert(reader.window_size < json.size());
+
+        jacc::BasicParser p(reader);
+
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root.array().size() == 5000);
+
+        for (int i = 0; i < 5000; ++i) {
+            assert(root[i]["id"].int64() == i);
+            assert(root[i]["name"].string() == "item \"" + std::to_string(i) + "\"");
+            assert(root[i]["price"].number() == i + 0.25);
+        }
+
+        //Only one region is mapped at a time
+        assert(reader.map_length <= reader.window_size);
+        assert(reader.map_offset > 0);
+    } //Closes file
+
+    std::remove(file_name);
+
+    jacc::WindowedMappedReader missing("__missing.json");
+
+    assert(missing.error_code == jacc::ERROR_IO);
+    assert(missing.peek() == '\0');
+}
+
+#ifdef JACC_WITH_ZLIB
+void test_gzip_reader() {
+    const char* file_name = "__test.json.gz";
+    std::string json = "[";
+
+    for (int i = 0; i < 20000; ++i) {
+        json += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"name\": \"item " + std::to_string(i) + "\"}";
+    }
+
+    json += "]";
+
+    //Two gzip members, split in the middle of a value
+    size_t half = json.size() / 2;
+
+    for (int member = 0; member < 2; ++member) {
+        gzFile gz = gzopen(file_name, member == 0 ? "wb" : "ab");
+        std::string part = member == 0 ? json.substr(0, half) : json.substr(half);
+
+        gzwrite(gz, part.data(), static_cast<unsigned>(part.size()));
+        gzclose(gz);
+    }
+
+    {
+        jacc::GzipReader reader(file_name, 1000);
+        jacc::BasicParser p(reader);
+
+        auto root = p.parse();
+
+        assert(reader.error_code == jacc::ERROR_NONE);
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root.array().size() == 20000);
+        assert(root[19999]["name"].string() == "item 19999");
+    } //Closes file
+
+    //Truncated input is an error
+    {
+        std::ifstream in(file_name, std::ios::binary);
+        std::string compressed((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(file_name, std::ios::binary);
+
+        out << compressed.substr(0, compressed.size() / 4);
+    } //Closes files
+
+    {
+        jacc::GzipReader reader(file_name);
+        jacc::BasicParser p(reader);
+
+        p.parse();
+
+        assert(reader.error_code == jacc::ERROR_IO);
+        assert(p.error_code != jacc::ERROR_NONE);
+    } //Closes file
+
+    std::remove(file_name);
+}
+#endif
+
+#ifdef JACC_WITH_ZSTD
+void test_zstd_reader() {
+    const char* file_name = "__test.json.zst";
+    std::string json = "{\"values\": [";
+
+    for (int i = 0; i < 20000; ++i) {
+        json += (i ? ", " : "") + std::to_string(i * 3);
+    }
+
+    json += "], \"name\": \"Bugs Bunny\"}";
+
+    {
+        std::string compressed(ZSTD_compressBound(json.size()), '\0');
+        size_t size = ZSTD_compress(&compressed[0], compressed.size(), json.data(), json.size(), 3);
+        std::ofstream out(file_name, std::ios::binary);
+
+        assert(!ZSTD_isError(size));
+        out.write(compressed.data(), size);
+    } //Closes file
+
+    {
+        jacc::ZstdReader reader(file_name, 1000);
+        jacc::BasicParser p(reader);
+
+        auto root = p.parse();
+
+        assert(reader.error_code == jacc::ERROR_NONE);
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root["values"].array().size() == 20000);
+        assert(root["values"][19999].int64() == 59997);
+        assert(root["name"].string() == "Bugs Bunny");
+    } //Closes file
+
+    std::remove(file_name);
+}
+#endif
+
+//Adds up "amount" members and counts events
+struct AmountHandler : jacc::SaxHandler<AmountHandler> {
+    bool in_amount = false;
+    double total = 0;
+    int objects = 0;
+    int arrays = 0;
+    int strings = 0;
+    int integers = 0;
+    std::string last_string;
+
+    void start_object() {
+        ++objects;
+    }
+
+    void start_array() {
+        ++arrays;
+    }
+
+    void key(std::string_view name) {
+        in_amount = name == "amount";
+    }
+
+    void string(std::string_view s) {
+        ++strings;
+        last_string = s;
+    }
+
+    void integer(int64_t n) {
+        ++integers;
+        number(static_cast<double>(n));
+    }
+
+    void number(double n) {
+        if (in_amount) {
+            total += n;
+        }
+    }
+};
+
+void test_sax() {
+    const char* json = R"({"orders": [{"id": 1, "amount": 10.5, "paid": true}, {"id": 2, "amount": 4, "note": "Say \"hi\""}, {"id": 3, "amount": 0.25, "tags": [], "extra": null}]})";
+
+    {
+        jacc::StringReader reader(json);
+        jacc::BasicParser p(reader);
+        AmountHandler handler;
+
+        p.parse(handler);
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(handler.total == 14.75);
+        assert(handler.objects == 4);
+        assert(handler.arrays == 2);
+        assert(handler.strings == 1);
+        assert(handler.integers == 4);
+        assert(handler.last_string == "Say \"hi\"");
+    }
+
+    //DOMBuilder makes the same tree as parse(), also through a small buffer
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name);
+
+        test_file << json;
+    } //Closes file
+
+    for (size_t size : {3, 4096}) {
+        jacc::FileReader reader(file_name, size);
+        jacc::BasicParser p(reader);
+        jacc::DOMBuilder builder;
+
+        p.parse(builder);
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(builder.stack.empty());
+
+        jacc::StringReader dom_reader(json);
+        jacc::BasicParser dom_parser(dom_reader);
+        auto root = dom_parser.parse();
+
+        assert(json_equals(root, builder.root));
+        assert(builder.root["orders"][1]["note"].string() == "Say \"hi\"");
+    } //Closes file
+
+    std::remove(file_name);
+
+    //With a resource, strings are copied into it
+    {
+        jacc::Arena arena;
+        jacc::StringReader arena_reader(json);
+        jacc::BasicParser arena_parser(arena_reader);
+        jacc::DOMBuilder builder(&arena.resource);
+
+        arena_parser.parse(builder);
+
+        assert(arena_parser.error_code == jacc::ERROR_NONE);
+        assert(std::holds_alternative<std::string_view>(builder.root["orders"][1]["note"].value));
+        assert(builder.root["orders"][1]["note"].string() == "Say \"hi\"");
+    }
+
+    const char* invalid[] = {R"({"a" 1})", R"({"a": 1,})", R"([1 2])", R"([1, 2)", R"({"a": tru})", R"("text")", R"([01])"};
+
+    for (const char* bad : invalid) {
+        jacc::StringReader bad_reader(bad);
+        jacc::BasicParser bad_parser(bad_reader);
+        AmountHandler handler;
+
+        bad_parser.parse(handler);
+
+        assert(bad_parser.error_code == jacc::ERROR_SYNTAX);
+    }
+}
+
+void test_on_demand() {
+    const char* json = R"({"meta": {"skip": [1, [2, {"x": "]}"}], "\"q\""]}, "users": [
+        {"id": 18446744073709551615, "name": "Bugs \"Bunny\"", "active": true, "tags": []},
+        {"id": 2, "name": "Daffy", "active": false, "score": -1.5, "manager": null},
+        {"id": 3, "name": "Roger"}
+    ]})";
+    jacc::StringReader reader(json);
+    jacc::OnDemand doc(reader);
+
+    assert(doc["users"][0]["id"].uint64() == UINT64_MAX);
+    assert(doc["users"][0]["name"].string() == "Bugs \"Bunny\"");
+    assert(doc["users"][0]["active"].boolean());
+    assert(doc["users"][1]["name"].view() == "Daffy");
+    assert(doc["users"][1]["score"].number() == -1.5);
+    assert(doc["users"][1]["manager"].isNull());
+    assert(doc["users"][2]["id"].int64() == 3);
+    assert(doc["users"][0]["tags"].isArray());
+    assert(doc["users"].isArray() && doc["meta"].isObject());
+    assert(doc.error_code == jacc::ERROR_NONE);
+
+    //Forward iteration over an array
+    int64_t sum = 0;
+    int count = 0;
+
+    for (auto user : doc["users"]) {
+        //The first id does not fit in an int64_t
+        if (count++ > 0) {
+            sum += user["id"].int64();
+        }
+    }
+
+    assert(count == 3 && sum == 5);
+
+    for (auto tag : doc["users"][0]["tags"]) {
+        (void) tag;
+        assert(false);
+    }
+
+    //Skipped subtree can be materialized on request
+    auto meta = doc["meta"].materialize();
+
+    assert(meta["skip"][1][1]["x"].string() == "]}");
+    assert(meta["skip"][2].string() == "\"q\"");
+    assert(doc.error_code == jacc::ERROR_NONE);
+
+    //Missing values are undefined and reading them is an error
+    assert(doc["users"][5].isUndefined());
+    assert(doc["nobody"]["id"].isUndefined());
+    assert(doc.error_code == jacc::ERROR_INVALID_TYPE);
+
+    jacc::OnDemand doc2(reader);
+
+    assert(doc2["users"][0]["id"].int64() == 0);
+    assert(doc2.error_code == jacc::ERROR_INVALID_TYPE);
+
+    jacc::OnDemand doc3(reader);
+
+    assert(doc3["users"][1]["name"].number() == 0);
+    assert(doc3.error_code == jacc::ERROR_INVALID_TYPE);
+
+    //Syntax errors on the scanned path are reported
+    jacc::StringReader bad_reader(R"({"a": [1, 2, "unterminated}, "b": 1})");
+    jacc::OnDemand bad(bad_reader);
+
+    bad["b"].int64();
+
+    assert(bad.error_code == jacc::ERROR_SYNTAX);
+
+    //Input that ends where a value should start is an error, and nothing
+    //past the end is read
+    for (const char* text : {"{\"a\":", "{\"a\": ", "[1,", "[1, ", "[", "[ "}) {
+        std::string truncated(text);
+        jacc::StringReader truncated_reader(truncated);
+        jacc::OnDemand truncated_doc(truncated_reader);
+        int elements = 0;
+
+        if (truncated[0] == '{') {
+            assert(!truncated_doc["a"].isNull());
+            assert(truncated_doc["a"].isUndefined());
+        }
+        else {
+            for (auto element : truncated_doc.root()) {
+                assert(element.isNumber());
+                ++elements;
+            }
+
+            assert(elements == (truncated.size() > 2 ? 1 : 0));
+        }
+
+        assert(truncated_doc.error_code == jacc::ERROR_SYNTAX);
+
+        jacc::OnDemandValue past_end(&truncated_doc, truncated.size());
+
+        assert(!past_end.isNumber());
+    }
+
+    //Plain parser skip_value through a tiny FileReader buffer
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name);
+
+        test_file << R"([{"a": "x\"]", "b": [[], {}]}, 42])";
+    } //Closes file
+
+    {
+        jacc::FileReader file_reader(file_name, 3);
+        jacc::BasicParser p(file_reader);
+
+        p.eat_space();
+        p.pop();
+        p.skip_value();
+        p.eat_space();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(p.pop() == ',');
+        assert(p.parse_value().int64() == 42);
+    } //Closes file
+
+    std::remove(file_name);
+}
+
+void test_push_parser() {
+    const char* json = R"( {"id": 18446744073709551615, "name": "Bugs \"Bunny\" \u00e9", "plain": "carrots", "scores": [1.5, -2, 3e2, true, false, null], "empty": {}, "list": [], "nested": [[{"a": [1]}]]} )";
+    std::string text(json);
+
+    //Build the tree from every split of the input into two chunks,
+    //and from one byte chunks
+    jacc::StringReader reader(json);
+    jacc::BasicParser p(reader);
+    auto expected = p.parse();
+
+    for (size_t split = 0; split <= text.size(); ++split) {
+        jacc::DOMBuilder builder;
+        jacc::PushParser<jacc::DOMBuilder> push(builder);
+
+        assert(push.feed(std::string_view(text).substr(0, split)) != jacc::PUSH_ERROR);
+        push.feed(std::string_view(text).substr(split));
+
+        assert(push.finish() == jacc::PUSH_DONE);
+        assert(json_equals(expected, builder.root));
+        assert(builder.root["name"].string() == "Bugs \"Bunny\" \u00e9");
+        assert(builder.root["id"].uint64() == UINT64_MAX);
+    }
+
+    {
+        jacc::DOMBuilder builder;
+        jacc::PushParser<jacc::DOMBuilder> push(builder);
+
+        for (char ch : text) {
+            assert(push.feed(std::string_view(&ch, 1)) != jacc::PUSH_ERROR);
+        }
+
+        assert(push.status() == jacc::PUSH_DONE);
+        assert(json_equals(expected, builder.root));
+    }
+
+    //Incomplete input asks for more and fails only at finish()
+    {
+        AmountHandler handler;
+        jacc::PushParser<AmountHandler> push(handler);
+
+        assert(push.feed(R"({"amount": 12)") == jacc::PUSH_MORE);
+        //Events so far were delivered
+        assert(handler.objects == 1);
+        assert(push.feed(R"(.5, "amount": 1)") == jacc::PUSH_MORE);
+        assert(handler.total == 12.5);
+        assert(push.finish() == jacc::PUSH_ERROR);
+    }
+
+    const char* invalid[] = {R"({"a" 1})", R"({"a": 1,})", R"([1 2])", R"([1, 2})", R"({"a": tru})", R"("text")", R"([01])", R"([1] x)", "[\"a\u0001\"]", R"(["\q"])"};
+
+    for (const char* bad : invalid) {
+        AmountHandler handler;
+        jacc::PushParser<AmountHandler> push(handler);
+
+        push.feed(bad);
+        push.finish();
+
+        assert(push.error_code == jacc::ERROR_SYNTAX);
+    }
+
+    //Nesting is limited by max_depth, in any chunks
+    {
+        AmountHandler handler;
+        jacc::PushParser<AmountHandler> push(handler);
+        std::string deep(100000, '[');
+
+        assert(push.feed(std::string_view(deep).substr(0, 600)) == jacc::PUSH_MORE);
+        assert(push.feed(std::string_view(deep).substr(600)) == jacc::PUSH_ERROR);
+        assert(push.error_code == jacc::ERROR_DEPTH);
+        assert(push.stack.size() == 1024);
+    }
+
+    jacc::ParseOptions options;
+
+    options.max_depth = 2;
+
+    for (const char* text : {R"({"a": [1]})", R"({"a": [{}]})"}) {
+        AmountHandler handler;
+        jacc::PushParser<AmountHandler> push(handler, options);
+
+        push.feed(text);
+
+        assert(push.finish() == (strlen(text) == 10 ? jacc::PUSH_DONE : jacc::PUSH_ERROR));
+    }
+}
+
+void test_max_depth() {
+    //Far deeper than the default limit fails cleanly instead of
+    //overflowing the stack
+    std::string deep = std::string(100000, '[') + std::string(100000, ']');
+
+    {
+        jacc::StringReader reader(deep);
+        jacc::BasicParser p(reader);
+
+        p.parse();
+
+        assert(p.error_code == jacc::ERROR_DEPTH);
+        assert(p.frames.empty());
+    }
+
+    {
+        jacc::StringReader reader(deep);
+        jacc::BasicParser p(reader);
+        jacc::DOMBuilder builder;
+
+        p.parse(builder);
+
+        assert(p.error_code == jacc::ERROR_DEPTH);
+    }
+
+    {
+        jacc::StringReader reader(deep);
+        jacc::IndexedParser p(reader);
+
+        p.parse();
+
+        assert(p.error_code == jacc::ERROR_DEPTH);
+    }
+
+    //Nesting up to the limit parses
+    std::string json;
+
+    for (int i = 0; i < 500; ++i) {
+        json += "{\"a\": [";
+    }
+
+    json += "1";
+
+    for (int i = 0; i < 500; ++i) {
+        json += "]}";
+    }
+
+    {
+        jacc::StringReader reader(json);
+        jacc::BasicParser p(reader);
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+
+        jacc::JSONObject* value = &root;
+
+        for (int i = 0; i < 500; ++i) {
+            value = &(*value)["a"][0];
+        }
+
+        assert(value->number() == 1.0);
+
+        jacc::StringReader indexed_reader(json);
+        jacc::IndexedParser ip(indexed_reader);
+
+        auto indexed_root = ip.parse();
+
+        assert(json_equals(root, indexed_root));
+        assert(ip.error_code == jacc::ERROR_NONE);
+    }
+
+    //A smaller limit is honored by every parser
+    jacc::ParseOptions options;
+
+    options.max_depth = 3;
+
+    for (const char* text : {"[[[1]]]", "[[[[1]]]]", "{\"a\": {\"b\": []}}", "{\"a\": {\"b\": [{}]}}"}) {
+        bool fits = std::count(text, text + strlen(text), '[') + std::count(text, text + strlen(text), '{') <= 3;
+        jacc::ErrorCode expected = fits ? jacc::ERROR_NONE : jacc::ERROR_DEPTH;
+
+        jacc::StringReader reader(text);
+        jacc::BasicParser p(reader, options);
+
+        p.parse();
+        assert(p.error_code == expected);
+
+        jacc::StringReader sax_reader(text);
+        jacc::BasicParser sax_parser(sax_reader, options);
+        jacc::DOMBuilder builder;
+
+        sax_parser.parse(builder);
+        assert(sax_parser.error_code == expected);
+
+        jacc::StringReader indexed_reader(text);
+        jacc::IndexedParser ip(indexed_reader, options);
+
+        ip.parse();
+        assert(ip.error_code == expected);
+    }
+
+    //Without a practical limit a very deep tree is built, replaced and
+    //destroyed without recursing
+    options.max_depth = SIZE_MAX;
+
+    std::string deeper;
+
+    for (int i = 0; i < 100000; ++i) {
+        deeper += "[{\"a\": ";
+    }
+
+    deeper += "1";
+
+    for (int i = 0; i < 100000; ++i) {
+        deeper += "}]";
+    }
+
+    {
+        jacc::StringReader reader(deeper);
+        jacc::BasicParser p(reader, options);
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root[0]["a"][0]["a"].isArray());
+
+        jacc::StringReader second_reader(deeper);
+        jacc::BasicParser second(second_reader, options);
+
+        root = second.parse();
+
+        assert(second.error_code == jacc::ERROR_NONE);
+    }
+
+    //parse_object() and parse_array() parse the container at the current
+    //position and fail on anything else
+    for (const char* text : {" {\"a\": [1]}", " [1, {}]", "1", ""}) {
+        bool is_object = std::string_view(text).substr(0, 2) == " {";
+        bool is_array = std::string_view(text).substr(0, 2) == " [";
+        jacc::StringReader object_reader(text);
+        jacc::BasicParser object_parser(object_reader);
+        auto object = object_parser.parse_object();
+
+        assert(object.isObject() == is_object);
+        assert((object_parser.error_code == jacc::ERROR_NONE) == is_object);
+
+        jacc::StringReader array_reader(text);
+        jacc::BasicParser array_parser(array_reader);
+        auto array = array_parser.parse_array();
+
+        assert(array.isArray() == is_array);
+        assert((array_parser.error_code == jacc::ERROR_NONE) == is_array);
+    }
+}
+
+void test_record_stream() {
+    std::string ndjson = "{\"id\": 1, \"name\": \"a\"}\n"
+        "\n"
+        "[1, 2, 3]\r\n"
+        "{\"id\": 2, \"name\": \"b\"\n"
+        "  \"text\" \n"
+        "{\"id\": 3} {\"id\": 4}\n"
+        "42\n"
+        "{\"id\": 5, \"tags\": [\"x\"]}";
+
+    //Stops at the first bad line
+    {
+        jacc::StringReader reader(ndjson);
+        jacc::RecordStream stream(reader);
+        jacc::JSONObject record;
+
+        assert(stream.next(record));
+        assert(record["name"].view() == "a");
+        assert(stream.next(record));
+        assert(record[2].number() == 3.0);
+        assert(stream.line == 3);
+        assert(!stream.next(record));
+        assert(stream.error_code == jacc::ERROR_SYNTAX);
+        assert(stream.line == 4);
+        assert(stream.offset == ndjson.find("{\"id\": 2"));
+        assert(!stream.next(record));
+    }
+
+    //Skips bad lines and reports where they are, through a reader that
+    //refills in small pieces, one that is mapped and a string
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name, std::ios::binary);
+
+        test_file << ndjson;
+    } //Closes file
+
+    auto check = [&](auto& reader) {
+        jacc::ParseOptions options;
+
+        options.zero_copy = true;
+
+        jacc::RecordStream stream(reader, options);
+        jacc::JSONObject record;
+        std::vector<std::string> values;
+
+        stream.skip_invalid = true;
+
+        while (stream.next(record)) {
+            if (record.isObject()) {
+                values.push_back(std::to_string(static_cast<int>(record["id"].number())));
+            }
+            else if (record.isArray()) {
+                values.push_back("array");
+            }
+            else if (record.isString()) {
+                values.push_back(std::string(record.view()));
+            }
+            else {
+                values.push_back(std::to_string(static_cast<int>(record.number())));
+            }
+        }
+
+        assert(stream.error_code == jacc::ERROR_NONE);
+        assert((values == std::vector<std::string>{"1", "array", "text", "42", "5"}));
+        assert(record["tags"][0].view() == "x");
+        assert(stream.errors.size() == 2);
+        assert(stream.errors[0].line == 4);
+        assert(stream.errors[0].offset == ndjson.find("{\"id\": 2"));
+        assert(stream.errors[1].line == 6);
+        assert(stream.errors[1].offset == ndjson.find("{\"id\": 3"));
+        assert(stream.errors[1].error_code == jacc::ERROR_SYNTAX);
+    };
+
+    {
+        jacc::StringReader reader(ndjson);
+
+        check(reader);
+    }
+
+    for (size_t size : {5, 4096}) {
+        jacc::FileReader reader(file_name, size);
+
+        check(reader);
+    }
+
+    {
+        jacc::MemoryMappedReader reader(file_name);
+
+        check(reader);
+    }
+}
+
+void test_parallel_records() {
+    //Lines of different lengths, some longer than a chunk
+    std::string ndjson;
+
+    for (int i = 0; i < 2000; ++i) {
+        ndjson += "{\"id\": " + std::to_string(i) + ", \"pad\": \"" + std::string(i % 97, 'x') + "\"}\n";
+    }
+
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name, std::ios::binary);
+
+        test_file << ndjson;
+    } //Closes file
+
+    jacc::ParallelOptions parallel;
+
+    parallel.threads = 4;
+    parallel.chunk_size = 100;
+    parallel.queue_size = 3;
+
+    for (bool arenas : {true, false}) {
+        parallel.arenas = arenas;
+
+        jacc::MemoryMappedReader reader(file_name);
+        jacc::ParallelRecordStream stream(reader, jacc::ParseOptions(), parallel);
+
+        assert(stream.chunk_count() == (ndjson.size() + 99) / 100);
+
+        //A second pass reuses the arenas
+        for (int pass = 0; pass < 2; ++pass) {
+            int expected = 0;
+
+            bool ok = stream.for_each([&](jacc::JSONObject& record, size_t offset) {
+                assert(record["id"].number() == expected);
+                assert(ndjson.compare(offset, 7, "{\"id\": ") == 0);
+                ++expected;
+            });
+
+            assert(ok);
+            assert(expected == 2000);
+        }
+    }
+
+    //Every record exactly once without ordering
+    {
+        jacc::StringReader reader(ndjson);
+        jacc::ParallelRecordStream stream(reader, jacc::ParseOptions(), parallel);
+        std::mutex mutex;
+        std::vector<int> ids;
+
+        bool ok = stream.for_each_unordered([&](jacc::JSONObject& record, size_t) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            ids.push_back(static_cast<int>(record["id"].number()));
+        });
+
+        assert(ok);
+        assert(ids.size() == 2000);
+        std::sort(ids.begin(), ids.end());
+
+        for (int i = 0; i < 2000; ++i) {
+            assert(ids[i] == i);
+        }
+    }
+
+    //Bad lines are skipped and reported with their line numbers, or stop
+    //the ordered stream after the records before them
+    std::string bad = ndjson;
+
+    bad.replace(bad.find("{\"id\": 700,"), 1, "[");
+    bad.replace(bad.find("{\"id\": 1500,"), 1, "x");
+
+    {
+        jacc::StringReader reader(bad);
+        jacc::ParallelRecordStream stream(reader, jacc::ParseOptions(), parallel);
+        std::atomic<int> count(0);
+
+        stream.skip_invalid = true;
+
+        assert(stream.for_each_unordered([&](jacc::JSONObject&, size_t) {
+            ++count;
+        }));
+        assert(count == 1998);
+        assert(stream.errors.size() == 2);
+        assert(stream.errors[0].line == 701);
+        assert(stream.errors[0].offset == bad.find("[\"id\": 700,"));
+        assert(stream.errors[1].line == 1501);
+    }
+
+    {
+        jacc::StringReader reader(bad);
+        jacc::ParallelRecordStream stream(reader, jacc::ParseOptions(), parallel);
+        int count = 0;
+
+        assert(!stream.for_each([&](jacc::JSONObject&, size_t) {
+            ++count;
+        }));
+        assert(count == 700);
+        assert(stream.error_code == jacc::ERROR_SYNTAX);
+        assert(stream.line == 701);
+    }
+
+    //Empty input
+    {
+        jacc::StringReader reader("");
+        jacc::ParallelRecordStream stream(reader);
+
+        assert(stream.for_each([](jacc::JSONObject&, size_t) {
+            assert(false);
+        }));
+    }
+}
+
+void test_parallel_array() {
+    std::string json = "[";
+
+    for (int i = 0; i < 3000; ++i) {
+        json += (i ? ",\n  " : "") + std::string("{\"id\": ") + std::to_string(i) +
+            ", \"s\": \"a,]\\\"[" + std::to_string(i) + "\", \"list\": [" + std::to_string(i) + ", {\"x\": [true]}]}";
+    }
+
+    json += ", \"tail\", 42, [], null ]  ";
+
+    jacc::StringReader serial_reader(json);
+    jacc::BasicParser serial(serial_reader);
+    auto expected = serial.parse();
+
+    assert(serial.error_code == jacc::ERROR_NONE);
+
+    jacc::ParallelOptions parallel;
+
+    parallel.threads = 4;
+    parallel.chunk_size = 256;
+
+    //From the heap, and from a thread safe resource
+    std::pmr::synchronized_pool_resource pool;
+
+    for (std::pmr::memory_resource* resource : {static_cast<std::pmr::memory_resource*>(nullptr), static_cast<std::pmr::memory_resource*>(&pool)}) {
+        jacc::ParseOptions options;
+
+        options.resource = resource;
+
+        jacc::StringReader reader(json);
+        jacc::ParallelArrayParser p(reader, options, parallel);
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root.array().size() == 3004);
+        assert(json_equals(expected, root));
+        assert(root[2999]["s"].view() == "a,]\"[2999");
+    }
+
+    //The result outlives the parser and later parses
+    {
+        jacc::JSONObject root;
+
+        {
+            jacc::StringReader reader(json);
+            jacc::ParallelArrayParser p(reader, jacc::ParseOptions(), parallel);
+
+            root = p.parse();
+
+            reader.data = "[1]";
+            reader.location = 0;
+
+            assert(p.parse().array().size() == 1);
+        }
+
+        assert(json_equals(expected, root));
+    }
+
+    for (const char* text : {"[]", " [ ] ", "[1]", "[[1, 2], {\"a\": [3]}]"}) {
+        jacc::StringReader reader(text);
+        jacc::ParallelArrayParser p(reader);
+        auto root = p.parse();
+
+        jacc::StringReader serial_text_reader(text);
+        jacc::BasicParser serial_text(serial_text_reader);
+        auto serial_root = serial_text.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(json_equals(serial_root, root));
+    }
+
+    const char* bad[] = {"{\"a\": 1}", "[1, 2", "[1,, 2]", "[1, 2,]", "[1 2]", "[{\"a\": 1]}", "[\"abc]", "[1] x", "[{\"a\" 1}]"};
+
+    for (const char* text : bad) {
+        jacc::StringReader reader(text);
+        jacc::ParallelArrayParser p(reader, jacc::ParseOptions(), parallel);
+
+        p.parse();
+
+        assert(p.error_code == jacc::ERROR_SYNTAX);
+    }
+
+    //Errors say which element failed
+    std::string broken = json;
+    size_t pos = broken.find("{\"id\": 1234,");
+
+    broken[pos + 5] = ' ';
+
+    jacc::StringReader reader(broken);
+    jacc::ParallelArrayParser p(reader, jacc::ParseOptions(), parallel);
+
+    p.parse();
+
+    assert(p.error_code == jacc::ERROR_SYNTAX);
+    assert(broken.compare(p.offset, 3, "\n  ") == 0);
+    assert(p.offset + 3 == pos);
+}
+
+void test_array_stream() {
+    std::string json = " [";
+
+    for (int i = 0; i < 500; ++i) {
+        json += (i ? ",\n" : "") + std::string("{\"id\": ") + std::to_string(i) + ", \"tags\": [\"t" + std::to_string(i) + "\"]}";
+    }
+
+    json += ", 7, \"last\"] ";
+
+    {
+        jacc::StringReader reader(json);
+        int id = 0;
+
+        auto stream = jacc::array_stream(reader);
+
+        for (jacc::JSONObject& element : stream) {
+            if (id < 500) {
+                assert(element["id"].number() == id);
+                assert(element["tags"][0].view() == "t" + std::to_string(id));
+            }
+
+            ++id;
+        }
+
+        assert(stream.error_code == jacc::ERROR_NONE);
+        assert(stream.count == 502);
+        assert(id == 502);
+        assert(stream.current.view() == "last");
+    }
+
+    //Any reader, including one that refills a small buffer
+    const char* file_name = "__test.json";
+
+    {
+        std::ofstream test_file(file_name, std::ios::binary);
+
+        test_file << json;
+    } //Closes file
+
+    {
+        jacc::FileReader reader(file_name, 7);
+        jacc::ArrayStream<jacc::FileReader> stream(reader);
+        jacc::JSONObject element;
+        size_t count = 0;
+
+        while (stream.next(element)) {
+            ++count;
+        }
+
+        assert(stream.error_code == jacc::ERROR_NONE);
+        assert(count == 502);
+        assert(element.view() == "last");
+    }
+
+    {
+        jacc::FileReader file_reader(file_name);
+        jacc::Reader& reader = file_reader;
+        size_t count = 0;
+
+        for (auto& element : jacc::array_stream(reader)) {
+            count += element.isObject() ? 1 : 0;
+        }
+
+        assert(count == 500);
+    }
+
+    for (const char* text : {"[]", " [ ] "}) {
+        jacc::StringReader reader(text);
+        auto stream = jacc::array_stream(reader);
+
+        assert(stream.begin() == stream.end());
+        assert(stream.error_code == jacc::ERROR_NONE);
+    }
+
+    //Elements before an error are still delivered
+    std::pair<const char*, size_t> bad[] = {{"[1, 2, 3", 3}, {"[1, 2 3]", 2}, {"[1, 2, ]", 2}, {"[1, 2, {\"a\" 1}]", 2}, {"{\"a\": 1}", 0}, {"[1, 2] garbage", 2}, {"[] ]", 0}};
+
+    for (auto& [text, expected] : bad) {
+        jacc::StringReader reader(text);
+        auto stream = jacc::array_stream(reader);
+        size_t count = 0;
+
+        for (auto& element : stream) {
+            assert(element.number() == ++count);
+        }
+
+        assert(stream.error_code == jacc::ERROR_SYNTAX);
+        assert(count == expected);
+    }
+
+    //The root array counts toward max_depth
+    jacc::ParseOptions options;
+
+    options.max_depth = 2;
+
+    for (const char* text : {"[[1], [2]]", "[[[1]]]"}) {
+        jacc::StringReader reader(text);
+        auto stream = jacc::array_stream(reader, options);
+
+        for (auto& element : stream) {
+            assert(element.isArray());
+        }
+
+        assert(stream.error_code == (strlen(text) == 10 ? jacc::ERROR_NONE : jacc::ERROR_DEPTH));
+    }
+}
+
+void test_projection() {
+    const char* json = R"({"user": {"id": 7, "name": "Bugs", "a/b": 1, "friends": [{"id": 1}, {"id": 2}]},
+        "event": {"type": "click", "payload": {"x": [1, [2, "]"], {"y": "}\"{"}]}},
+        "items": [{"sku": "A1", "qty": 2}, {"qty": 1}, {"sku": "C3", "tags": ["x"]}],
+        "meta": "ignored", "count": 3})";
+
+    jacc::Projection projection{"/user/id", "/event/type", "/items/*/sku", "/user/a~1b"};
+    jacc::ParseOptions options;
+
+    options.projection = &projection;
+
+    for (size_t size : {0, 3}) {
+        const char* file_name = "__test.json";
+
+        {
+            std::ofstream test_file(file_name, std::ios::binary);
+
+            test_file << json;
+        } //Closes file
+
+        jacc::StringReader string_reader(json);
+        jacc::FileReader file_reader(file_name, size ? size : 4096);
+        jacc::Reader& reader = size ? static_cast<jacc::Reader&>(file_reader) : string_reader;
+        jacc::Parser p(reader, options);
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root.object().size() == 3);
+        assert(root["user"].object().size() == 2);
+        assert(root["user"]["id"].number() == 7.0);
+        assert(root["user"]["a/b"].number() == 1.0);
+        assert(root["event"].object().size() == 1);
+        assert(root["event"]["type"].view() == "click");
+        assert(root["items"].array().size() == 3);
+        assert(root["items"][0].object().size() == 1);
+        assert(root["items"][0]["sku"].view() == "A1");
+        assert(root["items"][1].object().empty());
+        assert(root["items"][2]["sku"].view() == "C3");
+        assert(root.object().count("meta") == 0);
+    }
+
+    //A named segment and "*" at the same place both apply, and indexes
+    //select array elements
+    {
+        jacc::Projection both{"/items/*/sku", "/items/1/qty", "/user/friends/1"};
+
+        options.projection = &both;
+
+        jacc::StringReader reader(json);
+        jacc::BasicParser p(reader, options);
+        auto root = p.parse();
+
+        assert(p.error_code == jacc::ERROR_NONE);
+        assert(root["items"][0].object().size() == 1);
+        assert(root["items"][1]["qty"].number() == 1.0);
+        assert(root["items"][2].object().size() == 1);
+        assert(root["user"]["friends"].array().size() == 1);
+        assert(root["user"]["friends"][0]["id"].number() == 2.0);
+    }
+
+    //"" keeps everything, no paths keep nothing but the root
+    {
+        jacc::Projection all{""};
+        jacc::Projection none;
+
+        options.projection = &all;
+
+        jacc::StringReader reader(json);
+        jacc::BasicParser p(reader, options);
+        auto root = p.parse();
+
+        jacc::StringReader full_reader(json);
+        jacc::BasicParser full(full_reader);
+        auto expected = full.parse();
+
+        assert(json_equals(expected, root));
+
+        options.projection = &none;
+
+        jacc::StringReader none_reader(json);
+        jacc::BasicParser none_parser(none_reader, options);
+
+        assert(none_parser.parse().object().empty());
+        assert(none_parser.error_code == jacc::ERROR_NONE);
+
+        //IndexedParser ignores the projection
+        jacc::StringReader indexed_reader(json);
+        jacc::IndexedParser ip(indexed_reader, options);
+
+        auto indexed = ip.parse();
+
+        assert(ip.error_code == jacc::ERROR_NONE);
+        assert(json_equals(expected, indexed));
+    }
+
+    jacc::Projection invalid;
+
+    assert(!invalid.add("user"));
+    assert(!invalid.add("/a~2"));
+    assert(invalid.add("/a~0~1"));
+
+    //Skipped values must still end properly
+    options.projection = &projection;
+
+    for (const char* text : {R"({"meta": "abc)", R"({"meta": [1, 2)", R"({"meta": 1 "user": {}})"}) {
+        jacc::StringReader reader(text);
+        jacc::BasicParser p(reader, options);
+
+        p.parse();
+
+        assert(p.error_code == jacc::ERROR_SYNTAX);
+    }
+
+    //Paths apply to each record of a stream
+    {
+        jacc::Projection ids{"/id"};
+
+        options.projection = &ids;
+
+        jacc::StringReader reader("{\"id\": 1, \"big\": [[[]]]}\n{\"big\": {}, \"id\": 2}\n");
+        jacc::RecordStream stream(reader, options);
+        jacc::JSONObject record;
+        double total = 0;
+
+        while (stream.next(record)) {
+            assert(record.object().size() == 1);
+            total += record["id"].number();
+        }
+
+        assert(stream.error_code == jacc::ERROR_NONE);
+        assert(total == 3.0);
+    }
+
+    //Skipped subtrees are scanned a block at a time. Move brackets in
+    //strings, escapes and strings that cross 64 byte blocks around.
+    jacc::Projection keep{"/keep"};
+    jacc::Isa all[] = {jacc::ISA_SCALAR, jacc::ISA_NEON, jacc::ISA_SSE42, jacc::ISA_AVX2, jacc::ISA_AVX512};
+
+    options.projection = &keep;
+
+    for (jacc::Isa isa : all) {
+        if (!jacc::force_isa(isa)) {
+            continue;
+        }
+
+        for (size_t pad = 0; pad < 130; ++pad) {
+            std::string text = "{\"skip\": [" + std::string(pad, ' ') + "{\"a\": \"]}\\\"[\", \"" + std::string(pad % 70, 'x') + "\"}, [[" +
+                std::string(pad % 40, ' ') + "\"" + std::string(2 * (pad % 35), '\\') + "\", {}]], \"}}" + std::string(pad, '[') + "\"], \"keep\": 1}";
+
+            const char* file_name = "__test.json";
+
+            {
+                std::ofstream test_file(file_name, std::ios::binary);
+
+                test_file << text;
+            } //Closes file
+
+            //Whole input in one window, and windows that end inside blocks
+            for (size_t size : {0, 100}) {
+                jacc::StringReader string_reader(text);
+                jacc::FileReader file_reader(file_name, size ? size : 4096);
+                jacc::Reader& reader = size ? static_cast<jacc::Reader&>(file_reader) : string_reader;
+                jacc::Parser p(reader, options);
+                auto root = p.parse();
+
+                assert(p.error_code == jacc::ERROR_NONE);
+                assert(root.object().size() == 1);
+                assert(root["keep"].number() == 1.0);
+            }
+
+            std::remove(file_name);
+        }
+    }
+
+    jacc::force_isa(jacc::detected_isa());
+}
+
 int main()
 {
     test_str_ctor();
@@ -408,4 +2432,35 @@ int main()
     test_utf16_decode();
     test_index_operators();
     test_type_operators();
+    test_basic_parser();
+    test_reader_window();
+    test_file_reader_refill();
+    test_long_strings();
+    test_scanner_isa();
+    test_indexed_parser();
+    test_escapes_and_whitespace();
+    test_zero_copy();
+    test_arena();
+    test_object_map();
+    test_numbers();
+    test_lazy_numbers();
+    test_packed_arrays();
+    test_file_reader_fd();
+    test_memory_map_strategy();
+    test_windowed_mapped_reader();
+#ifdef JACC_WITH_ZLIB
+    test_gzip_reader();
+#endif
+#ifdef JACC_WITH_ZSTD
+    test_zstd_reader();
+#endif
+    test_sax();
+    test_on_demand();
+    test_push_parser();
+    test_max_depth();
+    test_record_stream();
+    test_parallel_records();
+    test_parallel_array();
+    test_array_stream();
+    test_projection();
 }